@@ -3,16 +3,19 @@
 
 #include <constants>
 
-vec4 decompress_light(float compressed_light) {
+vec4 decompress_light(uint compressed) {
     vec4 result;
-    int compressed = floatBitsToInt(compressed_light);
-    result.r = ((compressed >> 24) & 0xFF) / 255.f;
-    result.g = ((compressed >> 16) & 0xFF) / 255.f;
-    result.b = ((compressed >> 8) & 0xFF) / 255.f;
-    result.a = (compressed & 0xFF) / 255.f;
+    result.r = ((compressed >> 24) & 0xFFu) / 255.f;
+    result.g = ((compressed >> 16) & 0xFFu) / 255.f;
+    result.b = ((compressed >> 8) & 0xFFu) / 255.f;
+    result.a = (compressed & 0xFFu) / 255.f;
     return result;
 }
 
+vec4 decompress_light(float compressed_light) {
+    return decompress_light(floatBitsToUint(compressed_light));
+}
+
 vec3 pick_sky_color(samplerCube cubemap) {
     vec3 skyLightColor = texture(cubemap, vec3(0.4f, 0.0f, 0.4f)).rgb;
     skyLightColor *= SKY_LIGHT_TINT;
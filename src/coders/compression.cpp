@@ -0,0 +1,112 @@
+#include "compression.hpp"
+
+#define ZLIB_CONST
+#include <zlib.h>
+
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "lz4.hpp"
+#include "rle.hpp"
+
+using namespace compression;
+
+std::optional<Method> compression::Method_from(std::string_view str) {
+    if (str == "none") {
+        return Method::NONE;
+    } else if (str == "extrle") {
+        return Method::EXTRLE;
+    } else if (str == "deflate") {
+        return Method::DEFLATE;
+    } else if (str == "lz4") {
+        return Method::LZ4;
+    }
+    return std::nullopt;
+}
+
+bool compression::is_valid(ubyte id) {
+    return id >= static_cast<ubyte>(Method::NONE) &&
+           id <= static_cast<ubyte>(Method::LZ4);
+}
+
+size_t compression::bound(size_t srclen, Method method) {
+    switch (method) {
+        case Method::NONE:
+            return srclen;
+        case Method::EXTRLE:
+            // every byte may become a separate sequence
+            return srclen * 2;
+        case Method::DEFLATE:
+            return compressBound(srclen);
+        case Method::LZ4:
+            return lz4::bound(srclen);
+        default:
+            throw std::runtime_error("unknown compression method");
+    }
+}
+
+size_t compression::compress(
+    const ubyte* src, size_t srclen, ubyte* dst, Method method, int level
+) {
+    switch (method) {
+        case Method::NONE:
+            std::memcpy(dst, src, srclen);
+            return srclen;
+        case Method::EXTRLE:
+            return extrle::encode(src, srclen, dst);
+        case Method::DEFLATE: {
+            uLongf length = compressBound(srclen);
+            int result = compress2(dst, &length, src, srclen, level);
+            if (result != Z_OK) {
+                throw std::runtime_error(
+                    "deflate compression failed: " + std::to_string(result)
+                );
+            }
+            return length;
+        }
+        case Method::LZ4:
+            return lz4::encode(src, srclen, dst);
+        default:
+            throw std::runtime_error("unknown compression method");
+    }
+}
+
+std::unique_ptr<ubyte[]> compression::compress(
+    const ubyte* src, size_t srclen, size_t& len, Method method, int level
+) {
+    auto buffer = std::make_unique<ubyte[]>(bound(srclen, method));
+    len = compress(src, srclen, buffer.get(), method, level);
+    auto data = std::make_unique<ubyte[]>(len);
+    std::memcpy(data.get(), buffer.get(), len);
+    return data;
+}
+
+size_t compression::decompress(
+    const ubyte* src, size_t srclen, ubyte* dst, size_t dstlen, Method method
+) {
+    switch (method) {
+        case Method::NONE:
+            if (srclen > dstlen) {
+                throw std::runtime_error("data is out of bounds");
+            }
+            std::memcpy(dst, src, srclen);
+            return srclen;
+        case Method::EXTRLE:
+            return extrle::decode(src, srclen, dst, dstlen);
+        case Method::DEFLATE: {
+            uLongf length = dstlen;
+            int result = uncompress(dst, &length, src, srclen);
+            if (result != Z_OK) {
+                throw std::runtime_error(
+                    "deflate decompression failed: " + std::to_string(result)
+                );
+            }
+            return length;
+        }
+        case Method::LZ4:
+            return lz4::decode(src, srclen, dst, dstlen);
+        default:
+            throw std::runtime_error("unknown compression method");
+    }
+}
@@ -0,0 +1,90 @@
+#ifndef CODERS_COMPRESSION_HPP_
+#define CODERS_COMPRESSION_HPP_
+
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include <typedefs.hpp>
+
+namespace compression {
+    /// @brief Compression method id. Values are stored in files
+    enum class Method : ubyte {
+        NONE = 1,
+        EXTRLE,
+        /// @brief zlib stream (deflate)
+        DEFLATE,
+        /// @brief LZ4 block
+        LZ4
+    };
+
+    /// @brief Deflate compression level used by default
+    inline constexpr int DEFAULT_LEVEL = 6;
+
+    constexpr const char* to_string(Method method) {
+        switch (method) {
+            case Method::NONE:
+                return "none";
+            case Method::EXTRLE:
+                return "extrle";
+            case Method::DEFLATE:
+                return "deflate";
+            case Method::LZ4:
+                return "lz4";
+            default:
+                return "unknown";
+        }
+    }
+
+    std::optional<Method> Method_from(std::string_view str);
+
+    /// @brief Check if byte is a valid method id
+    bool is_valid(ubyte id);
+
+    /// @brief Get max compressed data length
+    /// @param srclen source data length
+    size_t bound(size_t srclen, Method method);
+
+    /// @brief Compress bytes array
+    /// @param src source bytes array
+    /// @param srclen length of source bytes array
+    /// @param dst destination buffer of at least bound(srclen) bytes
+    /// @param level compression level (1-9, deflate only)
+    /// @return compressed data length
+    size_t compress(
+        const ubyte* src,
+        size_t srclen,
+        ubyte* dst,
+        Method method,
+        int level = DEFAULT_LEVEL
+    );
+
+    /// @brief Compress bytes array
+    /// @param len (out argument) compressed data length
+    /// @return compressed bytes array
+    std::unique_ptr<ubyte[]> compress(
+        const ubyte* src,
+        size_t srclen,
+        size_t& len,
+        Method method,
+        int level = DEFAULT_LEVEL
+    );
+
+    /// @brief Decompress bytes array
+    /// @param src compressed data
+    /// @param srclen compressed data length
+    /// @param dst destination buffer
+    /// @param dstlen destination buffer length (max expected length of
+    /// the source data)
+    /// @return decompressed data length
+    /// @throws std::runtime_error if data is corrupted
+    size_t decompress(
+        const ubyte* src,
+        size_t srclen,
+        ubyte* dst,
+        size_t dstlen,
+        Method method
+    );
+}
+
+#endif  // CODERS_COMPRESSION_HPP_
@@ -0,0 +1,161 @@
+#include "lz4.hpp"
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+
+inline constexpr size_t MIN_MATCH = 4;
+/// @brief Last bytes are always stored as literals
+inline constexpr size_t LAST_LITERALS = 5;
+/// @brief Last match must start at least this number of bytes before end
+inline constexpr size_t MF_LIMIT = 12;
+inline constexpr size_t MAX_OFFSET = 0xFFFF;
+inline constexpr uint HASH_BITS = 12;
+
+static inline uint32_t read32(const ubyte* src) {
+    uint32_t value;
+    std::memcpy(&value, src, sizeof(value));
+    return value;
+}
+
+static inline uint hash32(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - HASH_BITS);
+}
+
+static inline size_t write_length(ubyte* dst, size_t length) {
+    size_t offset = 0;
+    while (length >= 255) {
+        dst[offset++] = 255;
+        length -= 255;
+    }
+    dst[offset++] = length;
+    return offset;
+}
+
+static size_t write_sequence(
+    ubyte* dst,
+    const ubyte* literals,
+    size_t literalsLength,
+    size_t offset,
+    size_t matchLength
+) {
+    size_t pos = 0;
+    ubyte& token = dst[pos++];
+    if (literalsLength >= 15) {
+        token = 15 << 4;
+        pos += write_length(dst + pos, literalsLength - 15);
+    } else {
+        token = literalsLength << 4;
+    }
+    std::memcpy(dst + pos, literals, literalsLength);
+    pos += literalsLength;
+    if (matchLength == 0) {
+        return pos;
+    }
+    dst[pos++] = offset & 0xFF;
+    dst[pos++] = offset >> 8;
+    size_t length = matchLength - MIN_MATCH;
+    if (length >= 15) {
+        token |= 15;
+        pos += write_length(dst + pos, length - 15);
+    } else {
+        token |= length;
+    }
+    return pos;
+}
+
+size_t lz4::encode(const ubyte* src, size_t srclen, ubyte* dst) {
+    size_t offset = 0;
+    size_t anchor = 0;
+    if (srclen > MF_LIMIT) {
+        // positions are stored +1, so zero is 'no position'
+        auto table = std::make_unique<uint32_t[]>(1 << HASH_BITS);
+        size_t matchLimit = srclen - LAST_LITERALS;
+        size_t pos = 0;
+        while (pos + MF_LIMIT <= srclen) {
+            uint32_t sequence = read32(src + pos);
+            uint32_t& slot = table[hash32(sequence)];
+            size_t ref = slot;
+            slot = pos + 1;
+            if (ref == 0 || pos - (ref - 1) > MAX_OFFSET ||
+                read32(src + ref - 1) != sequence) {
+                pos++;
+                continue;
+            }
+            ref--;
+            size_t length = MIN_MATCH;
+            while (pos + length < matchLimit &&
+                   src[ref + length] == src[pos + length]) {
+                length++;
+            }
+            offset += write_sequence(
+                dst + offset, src + anchor, pos - anchor, pos - ref, length
+            );
+            pos += length;
+            anchor = pos;
+        }
+    }
+    offset += write_sequence(dst + offset, src + anchor, srclen - anchor, 0, 0);
+    return offset;
+}
+
+static inline size_t read_length(
+    const ubyte* src, size_t srclen, size_t& pos
+) {
+    size_t length = 0;
+    ubyte value;
+    do {
+        if (pos >= srclen) {
+            throw std::runtime_error("lz4: unexpected end of data");
+        }
+        value = src[pos++];
+        length += value;
+    } while (value == 255);
+    return length;
+}
+
+size_t lz4::decode(
+    const ubyte* src, size_t srclen, ubyte* dst, size_t dstlen
+) {
+    size_t pos = 0;
+    size_t offset = 0;
+    while (pos < srclen) {
+        ubyte token = src[pos++];
+        size_t length = token >> 4;
+        if (length == 15) {
+            length += read_length(src, srclen, pos);
+        }
+        if (length > srclen - pos || length > dstlen - offset) {
+            throw std::runtime_error("lz4: literals are out of bounds");
+        }
+        std::memcpy(dst + offset, src + pos, length);
+        pos += length;
+        offset += length;
+        if (pos == srclen) {
+            break;
+        }
+        if (srclen - pos < 2) {
+            throw std::runtime_error("lz4: unexpected end of data");
+        }
+        size_t distance = src[pos] | (src[pos + 1] << 8);
+        pos += 2;
+        if (distance == 0 || distance > offset) {
+            throw std::runtime_error("lz4: invalid match offset");
+        }
+        length = token & 0xF;
+        if (length == 15) {
+            length += read_length(src, srclen, pos);
+        }
+        length += MIN_MATCH;
+        if (length > dstlen - offset) {
+            throw std::runtime_error("lz4: match is out of bounds");
+        }
+        // byte-by-byte copy as the match may overlap the output
+        const ubyte* match = dst + offset - distance;
+        for (size_t i = 0; i < length; i++) {
+            dst[offset + i] = match[i];
+        }
+        offset += length;
+    }
+    return offset;
+}
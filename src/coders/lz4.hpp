@@ -0,0 +1,32 @@
+#ifndef CODERS_LZ4_HPP_
+#define CODERS_LZ4_HPP_
+
+#include <typedefs.hpp>
+
+/// @brief LZ4 block format codec (no frame format, no checksums)
+namespace lz4 {
+    /// @brief Get max encoded data length
+    /// @param length source data length
+    constexpr size_t bound(size_t length) {
+        return length + length / 255 + 16;
+    }
+
+    /// @brief Encode bytes array
+    /// @param src source bytes array
+    /// @param length source bytes array length
+    /// @param dst destination buffer of at least bound(length) bytes
+    /// @return encoded data length
+    size_t encode(const ubyte* src, size_t length, ubyte* dst);
+
+    /// @brief Decode bytes array
+    /// @param src encoded data
+    /// @param length encoded data length
+    /// @param dst destination buffer
+    /// @param dstlen destination buffer length
+    /// @return decoded data length
+    /// @throws std::runtime_error if data is corrupted or does not fit
+    /// the destination buffer
+    size_t decode(const ubyte* src, size_t length, ubyte* dst, size_t dstlen);
+}
+
+#endif  // CODERS_LZ4_HPP_
@@ -1,5 +1,8 @@
 #include "rle.hpp"
 
+#include <cstring>
+#include <stdexcept>
+
 size_t rle::decode(const ubyte* src, size_t srclen, ubyte* dst) {
     size_t offset = 0;
     for (size_t i = 0; i < srclen;) {
@@ -51,6 +54,32 @@ size_t extrle::decode(const ubyte* src, size_t srclen, ubyte* dst) {
     return offset;
 }
 
+size_t extrle::decode(
+    const ubyte* src, size_t srclen, ubyte* dst, size_t dstlen
+) {
+    size_t offset = 0;
+    for (size_t i = 0; i < srclen;) {
+        uint len = src[i++];
+        if (len & 0x80) {
+            if (i >= srclen) {
+                throw std::runtime_error("extrle: unexpected end of data");
+            }
+            len &= 0x7F;
+            len |= ((uint)src[i++]) << 7;
+        }
+        if (i >= srclen) {
+            throw std::runtime_error("extrle: unexpected end of data");
+        }
+        ubyte c = src[i++];
+        if (len >= dstlen - offset) {
+            throw std::runtime_error("extrle: sequence is out of bounds");
+        }
+        std::memset(dst + offset, c, len + 1);
+        offset += len + 1;
+    }
+    return offset;
+}
+
 size_t extrle::encode(const ubyte* src, size_t srclen, ubyte* dst) {
     if (srclen == 0) {
         return 0;
@@ -12,6 +12,15 @@ namespace extrle {
     constexpr uint max_sequence = 0x7FFF;
     size_t encode(const ubyte* src, size_t length, ubyte* dst);
     size_t decode(const ubyte* src, size_t length, ubyte* dst);
+
+    /// @brief Decode bytes array checking bounds
+    /// @param dstlen destination buffer length
+    /// @return decoded data length
+    /// @throws std::runtime_error if data is truncated or does not fit
+    /// the destination buffer
+    size_t decode(
+        const ubyte* src, size_t length, ubyte* dst, size_t dstlen
+    );
 }
 
 #endif  // CODERS_RLE_HPP_
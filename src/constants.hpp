@@ -34,6 +34,13 @@ inline constexpr int ITEM_ICON_SIZE = 48;
 /// @brief chunk volume (count of voxels per Chunk)
 inline constexpr int CHUNK_VOL = (CHUNK_W * CHUNK_H * CHUNK_D);
 
+/// @brief chunk section (horizontal slice of chunk) height
+inline constexpr int CHUNK_SECTION_H = 16;
+/// @brief count of sections per Chunk
+inline constexpr int CHUNK_SECTIONS = CHUNK_H / CHUNK_SECTION_H;
+/// @brief chunk section volume (count of voxels per section)
+inline constexpr int CHUNK_SECTION_VOL = CHUNK_W * CHUNK_SECTION_H * CHUNK_D;
+
 /// @brief block id used to mark non-existing voxel (voxel of missing chunk)
 inline constexpr blockid_t BLOCK_VOID = std::numeric_limits<blockid_t>::max();
 /// @brief item id used to mark non-existing item (error)
@@ -0,0 +1,150 @@
+#include "RegionsJournal.hpp"
+
+#include <zlib.h>
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <debug/Logger.hpp>
+#include <util/data_io.hpp>
+#include "files.hpp"
+
+#define JOURNAL_FORMAT_MAGIC ".VOXJRN"
+
+static debug::Logger logger("regions-journal");
+
+/**
+  Regions journal format 1:
+    - byte-order: big-endian
+
+    ```cpp
+    char magic[8] = ".VOXJRN";
+    uint8_t version = 1;
+    struct {
+        int32_t x; // chunk.x
+        int32_t z; // chunk.z
+        uint8_t layer;
+        uint8_t compression; // compression::Method
+        uint32_t size;
+        uint32_t checksum; // crc32 of the record fields above and data
+        uint8_t data[size]; // chunk data as stored in region file
+    } records[]; // until the end of file
+    ```
+*/
+inline constexpr uint JOURNAL_FORMAT_VERSION = 1;
+inline constexpr uint JOURNAL_HEADER_SIZE = 9;
+inline constexpr uint JOURNAL_RECORD_HEADER_SIZE = 18;
+/// @brief Size of the record fields covered by the checksum
+inline constexpr uint JOURNAL_RECORD_FIELDS_SIZE = 14;
+
+static uint32_t record_checksum(
+    const ubyte* header, const ubyte* data, uint32_t size
+) {
+    uLong crc = crc32(0L, header, JOURNAL_RECORD_FIELDS_SIZE);
+    return crc32(crc, data, size);
+}
+
+RegionsJournal::RegionsJournal(const fs::path& file) : file(file) {
+    if (fs::is_regular_file(file)) {
+        length = fs::file_size(file);
+    }
+}
+
+void RegionsJournal::append(const std::vector<JournalRecord>& records) {
+    std::vector<ubyte> bytes;
+    bool create = length < JOURNAL_HEADER_SIZE;
+    if (create) {
+        bytes.resize(JOURNAL_HEADER_SIZE);
+        std::memcpy(bytes.data(), JOURNAL_FORMAT_MAGIC, 8);
+        bytes[8] = JOURNAL_FORMAT_VERSION;
+    }
+    for (const auto& record : records) {
+        size_t offset = bytes.size();
+        bytes.resize(offset + JOURNAL_RECORD_HEADER_SIZE + record.size);
+        ubyte* dst = bytes.data() + offset;
+        dataio::write_int32_big(record.x, dst, 0);
+        dataio::write_int32_big(record.z, dst, 4);
+        dst[8] = record.layer;
+        dst[9] = static_cast<ubyte>(record.compression);
+        dataio::write_int32_big(record.size, dst, 10);
+        dataio::write_int32_big(
+            record_checksum(dst, record.data, record.size), dst, 14
+        );
+        std::memcpy(dst + JOURNAL_RECORD_HEADER_SIZE, record.data, record.size);
+    }
+    auto mode = std::ios::binary | (create ? std::ios::trunc : std::ios::app);
+    std::ofstream output(file, mode);
+    if (!output.is_open()) {
+        throw std::runtime_error("could not open " + file.u8string());
+    }
+    output.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    output.close();
+    // records must survive OS crash and power loss too
+    if (!output.good() || !files::sync(file)) {
+        throw std::runtime_error("could not write " + file.u8string());
+    }
+    length = (create ? 0 : length.load()) + bytes.size();
+}
+
+size_t RegionsJournal::replay(const journalproc& func) {
+    if (!fs::is_regular_file(file)) {
+        return 0;
+    }
+    size_t size;
+    auto bytes = files::read_bytes(file, size);
+    if (size < JOURNAL_HEADER_SIZE) {
+        logger.warning() << "incomplete journal header, journal removed";
+        reset();
+        return 0;
+    }
+    const ubyte* data = bytes.get();
+    if (std::memcmp(data, JOURNAL_FORMAT_MAGIC, 8)) {
+        throw std::runtime_error("invalid journal magic number");
+    }
+    if (data[8] != JOURNAL_FORMAT_VERSION) {
+        throw std::runtime_error(
+            "unsupported journal format version " + std::to_string(data[8])
+        );
+    }
+    size_t count = 0;
+    size_t pos = JOURNAL_HEADER_SIZE;
+    while (pos + JOURNAL_RECORD_HEADER_SIZE <= size) {
+        const ubyte* header = data + pos;
+        uint32_t datalen = dataio::read_int32_big(header, 10);
+        if (datalen > size - pos - JOURNAL_RECORD_HEADER_SIZE) {
+            break;
+        }
+        const ubyte* src = header + JOURNAL_RECORD_HEADER_SIZE;
+        uint32_t checksum = dataio::read_int32_big(header, 14);
+        if (record_checksum(header, src, datalen) != checksum) {
+            break;
+        }
+        JournalRecord record {
+            dataio::read_int32_big(header, 0),
+            dataio::read_int32_big(header, 4),
+            header[8],
+            static_cast<compression::Method>(header[9]),
+            src,
+            datalen};
+        func(record);
+        count++;
+        pos += JOURNAL_RECORD_HEADER_SIZE + datalen;
+    }
+    if (pos < size) {
+        logger.warning() << "journal is corrupted at " << pos << ", "
+                         << (size - pos) << " bytes dropped";
+        fs::resize_file(file, pos);
+    }
+    length = pos;
+    return count;
+}
+
+void RegionsJournal::reset() {
+    fs::remove(file);
+    length = 0;
+}
+
+size_t RegionsJournal::getLength() const {
+    return length;
+}
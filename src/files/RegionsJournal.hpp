@@ -0,0 +1,54 @@
+#ifndef FILES_REGIONS_JOURNAL_HPP_
+#define FILES_REGIONS_JOURNAL_HPP_
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <vector>
+
+#include <coders/compression.hpp>
+#include <typedefs.hpp>
+
+namespace fs = std::filesystem;
+
+/// @brief Chunk data record of the regions journal
+struct JournalRecord {
+    int x;
+    int z;
+    int layer;
+    /// @brief Compression method used for the data
+    compression::Method compression;
+    const ubyte* data;
+    uint32_t size;
+};
+
+using journalproc = std::function<void(const JournalRecord&)>;
+
+/// @brief Append-only log of chunks data put to regions. Makes changes
+/// persistent without rewriting region files, which are updated later
+class RegionsJournal {
+    fs::path file;
+    std::atomic<size_t> length = 0;
+public:
+    RegionsJournal(const fs::path& file);
+
+    /// @brief Append records to the end of the journal. The file is synced
+    /// to the storage device before return
+    /// @throws std::runtime_error if the file could not be written
+    void append(const std::vector<JournalRecord>& records);
+
+    /// @brief Read all records in order they were appended. Incomplete or
+    /// corrupted record (left by interrupted append) is cut off the file
+    /// with all following data
+    /// @param func records handler
+    /// @return number of records read
+    size_t replay(const journalproc& func);
+
+    /// @brief Remove all records
+    void reset();
+
+    /// @return journal file size (0 if there is no journal file)
+    size_t getLength() const;
+};
+
+#endif  // FILES_REGIONS_JOURNAL_HPP_
@@ -1,14 +1,18 @@
 #include "WorldConverter.hpp"
 
+#include <cstring>
 #include <iostream>
 #include <memory>
 #include <stdexcept>
 #include <utility>
 
+#include <coders/binary_json.hpp>
+#include <coders/byte_utils.hpp>
 #include <content/ContentLUT.hpp>
 #include <data/dynamic.hpp>
 #include <debug/Logger.hpp>
 #include <files/files.hpp>
+#include <items/Inventory.hpp>
 #include <objects/Player.hpp>
 #include <util/ThreadPool.hpp>
 #include <voxels/Chunk.hpp>
@@ -39,16 +43,28 @@ WorldConverter::WorldConverter(
     : wfile(std::make_unique<WorldFiles>(folder)),
       lut(std::move(lut)),
       content(content) {
-    fs::path regionsFolder =
-        wfile->getRegions().getRegionsFolder(REGION_LAYER_VOXELS);
+    auto& regions = wfile->getRegions();
+    // journaled chunks are written to regions to be converted too
+    regions.replayJournal();
+    regions.write();
+    fs::path regionsFolder = regions.getRegionsFolder(REGION_LAYER_VOXELS);
     if (!fs::is_directory(regionsFolder)) {
         logger.error() << "nothing to convert";
         return;
     }
     tasks.push(convert_task {convert_task_type::player, wfile->getPlayerFile()}
     );
-    for (const auto& file : fs::directory_iterator(regionsFolder)) {
-        tasks.push(convert_task {convert_task_type::region, file.path()});
+    // entities are stored with definition names, so need no conversion
+    for (uint layer : {REGION_LAYER_VOXELS, REGION_LAYER_INVENTORIES}) {
+        fs::path folder = regions.getRegionsFolder(layer);
+        if (!fs::is_directory(folder)) {
+            continue;
+        }
+        for (const auto& file : fs::directory_iterator(folder)) {
+            tasks.push(
+                convert_task {convert_task_type::region, file.path(), layer}
+            );
+        }
     }
 }
 
@@ -89,20 +105,61 @@ std::shared_ptr<Task> WorldConverter::startTask(
     return pool;
 }
 
-void WorldConverter::convertRegion(const fs::path& file) const {
+/// @brief Replace item ids in chunk inventories data
+/// (see WorldRegions::fetchInventories)
+static std::unique_ptr<ubyte[]> convert_inventories(
+    const ubyte* data, size_t& size, const ContentLUT* lut
+) {
+    ByteReader reader(data, size);
+    ByteBuilder builder;
+    auto count = reader.getInt32();
+    builder.putInt32(count);
+    for (int i = 0; i < count; i++) {
+        builder.putInt32(reader.getInt32());
+        uint length = reader.getInt32();
+        auto map = json::from_binary(reader.pointer(), length);
+        reader.skip(length);
+        Inventory::convert(map.get(), lut);
+        auto bytes = json::to_binary(map.get(), false);
+        builder.putInt32(bytes.size());
+        builder.put(bytes.data(), bytes.size());
+    }
+    size = builder.size();
+    auto converted = std::make_unique<ubyte[]>(size);
+    std::memcpy(converted.get(), builder.data(), size);
+    return converted;
+}
+
+void WorldConverter::convertRegion(const fs::path& file, uint layer) const {
     int x, z;
     std::string name = file.stem().string();
     if (!WorldRegions::parseRegionFilename(name, x, z)) {
         logger.error() << "could not parse name " << name;
         return;
     }
-    logger.info() << "converting region " << name;
-    wfile->getRegions().processRegionVoxels(x, z, [=](ubyte* data) {
-        if (lut) {
-            Chunk::convert(data, lut.get());
-        }
-        return true;
-    });
+    logger.info() << "converting region " << name << " (layer " << layer
+                  << ")";
+    auto& regions = wfile->getRegions();
+    switch (layer) {
+        case REGION_LAYER_VOXELS:
+            // also upgrades region file format if no lut provided
+            regions.processRegion(x, z, layer, [this](auto& data, auto& size) {
+                if (lut) {
+                    Chunk::convert(data.get(), size, lut.get());
+                }
+                return true;
+            });
+            break;
+        case REGION_LAYER_INVENTORIES:
+            if (lut == nullptr) {
+                return;
+            }
+            regions.processRegion(x, z, layer, [this](auto& data, auto& size) {
+                data = convert_inventories(data.get(), size, lut.get());
+                return true;
+            });
+            break;
+    }
 }
 
 void WorldConverter::convertPlayer(const fs::path& file) const {
@@ -117,7 +174,7 @@ void WorldConverter::convert(const convert_task& task) const {
 
     switch (task.type) {
         case convert_task_type::region:
-            convertRegion(task.file);
+            convertRegion(task.file, task.layer);
             break;
         case convert_task_type::player:
             convertPlayer(task.file);
@@ -158,6 +215,7 @@ bool WorldConverter::isActive() const {
 void WorldConverter::write() {
     logger.info() << "writing world";
     wfile->write(nullptr, content);
+    wfile->waitForWrite();
 }
 
 void WorldConverter::waitForEnd() {
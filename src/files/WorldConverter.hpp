@@ -20,6 +20,8 @@ enum class convert_task_type { region, player };
 struct convert_task {
     convert_task_type type;
     fs::path file;
+    /// @brief Regions layer of the region file
+    uint layer = 0;
 };
 
 class WorldConverter : public Task {
@@ -31,7 +33,7 @@ class WorldConverter : public Task {
     uint tasksDone = 0;
 
     void convertPlayer(const fs::path& file) const;
-    void convertRegion(const fs::path& file) const;
+    void convertRegion(const fs::path& file, uint layer) const;
 public:
     WorldConverter(
         const fs::path& folder,
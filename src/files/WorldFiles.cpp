@@ -45,6 +45,34 @@ WorldFiles::WorldFiles(const fs::path& directory, const DebugSettings& settings)
     doWriteLights = settings.doWriteLights.get();
     regions.generatorTestMode = generatorTestMode;
     regions.doWriteLights = doWriteLights;
+    regions.paletteVoxels = settings.paletteVoxels.get();
+    regions.journaling =
+        !generatorTestMode && settings.journalInterval.get() > 0;
+    regions.maxCachedBytes =
+        static_cast<size_t>(settings.regionsCacheSize.get()) * 1024 * 1024;
+
+    const std::pair<uint, const StringSetting*> methods[] {
+        {REGION_LAYER_VOXELS, &settings.voxelsCompression},
+        {REGION_LAYER_LIGHTS, &settings.lightsCompression},
+        {REGION_LAYER_INVENTORIES, &settings.inventoriesCompression},
+        {REGION_LAYER_ENTITIES, &settings.entitiesCompression},
+    };
+    for (const auto& [layer, setting] : methods) {
+        const auto& name = setting->get();
+        if (auto method = compression::Method_from(name)) {
+            regions.setCompression(
+                layer, *method, settings.compressionLevel.get()
+            );
+        } else {
+            logger.warning() << "unknown compression method '" << name
+                             << "', using default";
+        }
+    }
+    try {
+        regions.replayJournal();
+    } catch (const std::exception& err) {
+        logger.error() << "could not replay regions journal: " << err.what();
+    }
 }
 
 WorldFiles::~WorldFiles() = default;
@@ -74,7 +102,9 @@ fs::path WorldFiles::getPacksFile() const {
     return directory / fs::path("packs.list");
 }
 
-void WorldFiles::write(const World* world, const Content* content) {
+std::shared_future<void> WorldFiles::write(
+    const World* world, const Content* content
+) {
     if (world) {
         writeWorldInfo(world);
         if (!fs::exists(getPacksFile())) {
@@ -82,11 +112,37 @@ void WorldFiles::write(const World* world, const Content* content) {
         }
     }
     if (generatorTestMode) {
-        return;
+        return {};
     }
 
     writeIndices(content->getIndices());
-    regions.write();
+    regionsWrite = regions.writeAsync();
+    return regionsWrite;
+}
+
+bool WorldFiles::waitForWrite() {
+    if (!regionsWrite.valid()) {
+        return true;
+    }
+    auto future = std::move(regionsWrite);
+    try {
+        future.get();
+    } catch (const std::exception& err) {
+        logger.error() << "could not write regions: " << err.what();
+        return false;
+    }
+    return true;
+}
+
+void WorldFiles::writeJournal(const Content* content) {
+    if (generatorTestMode) {
+        return;
+    }
+    if (regions.getJournalLength() >= REGIONS_JOURNAL_MAX_LENGTH) {
+        write(nullptr, content);
+    } else {
+        regions.writeJournal();
+    }
 }
 
 void WorldFiles::writePacks(const std::vector<ContentPack>& packs) {
@@ -2,6 +2,7 @@
 #define FILES_WORLD_FILES_HPP_
 
 #include <filesystem>
+#include <future>
 #include <glm/glm.hpp>
 #include <memory>
 #include <string>
@@ -28,6 +29,8 @@ namespace fs = std::filesystem;
 class WorldFiles {
     fs::path directory;
     WorldRegions regions;
+    /// @brief Regions write started by the last write call
+    std::shared_future<void> regionsWrite;
 
     bool generatorTestMode = false;
     bool doWriteLights = true;
@@ -50,10 +53,22 @@ public:
     bool readWorldInfo(World* world);
     bool readResourcesData(const Content* content);
 
-    /// @brief Write all unsaved data to world files
+    /// @brief Write all unsaved data to world files.
+    /// Regions are written in background (see WorldRegions::writeAsync)
     /// @param world target world
     /// @param content world content
-    void write(const World* world, const Content* content);
+    /// @return regions write future (invalid if regions are not written)
+    std::shared_future<void> write(const World* world, const Content* content);
+
+    /// @brief Wait until regions of the last write call are written
+    /// @return false if regions write failed (the error is logged)
+    bool waitForWrite();
+
+    /// @brief Write chunks data put to regions since the last call to the
+    /// regions journal in background. Regions are written instead if the
+    /// journal is too big (see REGIONS_JOURNAL_MAX_LENGTH)
+    /// @param content world content
+    void writeJournal(const Content* content);
 
     void writePacks(const std::vector<ContentPack>& packs);
 
@@ -0,0 +1,154 @@
+#include "WorldMaintenance.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <data/dynamic.hpp>
+#include <debug/Logger.hpp>
+#include "WorldRegions.hpp"
+
+static debug::Logger logger("world-maintenance");
+
+struct region_task {
+    int x;
+    int z;
+    uint layer;
+    regioncheck check {};
+    bool compacted = false;
+    /// @brief Size of the file after compaction
+    size_t compactedSize = 0;
+    std::string error;
+};
+
+/// @brief Check if region file is worth to be rewritten
+static bool is_compaction_needed(const regioncheck& check) {
+    if (check.version == 0) {
+        // header is damaged, nothing to be saved
+        return false;
+    }
+    return static_cast<uint>(check.version) < REGION_FORMAT_VERSION ||
+           check.corrupted.any() ||
+           check.getUnusedBytes() * 4 > check.fileSize;
+}
+
+WorldMaintenance::WorldMaintenance(const fs::path& folder)
+    : folder(folder), regions(std::make_unique<WorldRegions>(folder)) {
+}
+
+WorldMaintenance::~WorldMaintenance() {
+}
+
+dynamic::Map_sptr WorldMaintenance::checkRegions(bool compact) {
+    if (compact) {
+        regions->replayJournal();
+        regions->write();
+    }
+    std::vector<region_task> tasks;
+    for (uint layer = 0; layer < REGION_LAYERS_COUNT; layer++) {
+        fs::path layerFolder = regions->getRegionsFolder(layer);
+        if (!fs::is_directory(layerFolder)) {
+            continue;
+        }
+        for (const auto& file : fs::directory_iterator(layerFolder)) {
+            // temporary files left by interrupted compaction are skipped
+            int x, z;
+            std::string name = file.path().stem().u8string();
+            if (file.path().extension() != ".bin" ||
+                !WorldRegions::parseRegionFilename(name, x, z)) {
+                continue;
+            }
+            region_task task {};
+            task.x = x;
+            task.z = z;
+            task.layer = layer;
+            tasks.push_back(std::move(task));
+        }
+    }
+    logger.info() << "checking " << tasks.size() << " region files";
+
+    std::atomic<size_t> next = 0;
+    auto worker = [this, compact, &tasks, &next]() {
+        size_t index;
+        while ((index = next++) < tasks.size()) {
+            auto& task = tasks[index];
+            try {
+                task.check = regions->checkRegion(task.x, task.z, task.layer);
+                if (compact && is_compaction_needed(task.check)) {
+                    task.compactedSize = regions->compactRegion(
+                        task.x, task.z, task.layer, task.check
+                    );
+                    task.compacted = true;
+                }
+            } catch (const std::exception& err) {
+                task.error = err.what();
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    uint threadsCount = std::max(1U, std::thread::hardware_concurrency());
+    for (uint i = 0; i < threadsCount; i++) {
+        threads.emplace_back(worker);
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto root = std::make_shared<dynamic::Map>();
+    root->put("world", folder.u8string());
+    root->put("compact", compact);
+    auto& list = root->putList("regions");
+    size_t damaged = 0;
+    size_t compacted = 0;
+    size_t totalSize = 0;
+    size_t unusedBytes = 0;
+    size_t reclaimedBytes = 0;
+    for (const auto& task : tasks) {
+        const auto& check = task.check;
+        auto& map = list.putMap();
+        map.put("layer", task.layer);
+        map.put("x", task.x);
+        map.put("z", task.z);
+        map.put("version", check.version);
+        map.put("file-size", static_cast<uint64_t>(check.fileSize));
+        map.put(
+            "unused-bytes", static_cast<uint64_t>(check.getUnusedBytes())
+        );
+        map.put("chunks", check.chunks);
+        map.put(
+            "corrupted-chunks", static_cast<uint64_t>(check.corrupted.count())
+        );
+        auto& errors = map.putList("errors");
+        for (const auto& error : check.errors) {
+            errors.put(error);
+        }
+        if (!task.error.empty()) {
+            errors.put(task.error);
+        }
+        map.put("compacted", task.compacted);
+
+        if (!errors.values.empty()) {
+            damaged++;
+        }
+        totalSize += check.fileSize;
+        unusedBytes += check.getUnusedBytes();
+        if (task.compacted) {
+            compacted++;
+            if (check.fileSize > task.compactedSize) {
+                reclaimedBytes += check.fileSize - task.compactedSize;
+            }
+        }
+    }
+    root->put("damaged", static_cast<uint64_t>(damaged));
+    root->put("compacted", static_cast<uint64_t>(compacted));
+    root->put("total-size", static_cast<uint64_t>(totalSize));
+    root->put("unused-bytes", static_cast<uint64_t>(unusedBytes));
+    root->put("reclaimed-bytes", static_cast<uint64_t>(reclaimedBytes));
+    logger.info() << "damaged region files: " << damaged
+                  << ", compacted: " << compacted;
+    return root;
+}
@@ -0,0 +1,30 @@
+#ifndef FILES_WORLD_MAINTENANCE_HPP_
+#define FILES_WORLD_MAINTENANCE_HPP_
+
+#include <filesystem>
+#include <memory>
+
+#include <data/dynamic_fwd.hpp>
+
+namespace fs = std::filesystem;
+
+class WorldRegions;
+
+/// @brief Offline world maintenance: region files integrity check and
+/// compaction. World must not be open while running
+class WorldMaintenance {
+    fs::path folder;
+    std::unique_ptr<WorldRegions> regions;
+public:
+    /// @param folder world folder
+    WorldMaintenance(const fs::path& folder);
+    ~WorldMaintenance();
+
+    /// @brief Check region files of all layers in parallel
+    /// @param compact rewrite fragmented, damaged and older format region
+    /// files compactly. Journaled chunks are written to regions first
+    /// @return report with all found problems
+    dynamic::Map_sptr checkRegions(bool compact);
+};
+
+#endif  // FILES_WORLD_MAINTENANCE_HPP_
@@ -1,23 +1,71 @@
 #include "WorldRegions.hpp"
 
+#include <zlib.h>
+
+#include <algorithm>
+#include <cassert>
 #include <cstring>
+#include <string_view>
+#include <tuple>
 #include <utility>
 #include <vector>
 
 #include <coders/byte_utils.hpp>
-#include <coders/rle.hpp>
 #include <data/dynamic.hpp>
+#include <debug/Logger.hpp>
 #include <items/Inventory.hpp>
 #include <maths/voxmaths.hpp>
 #include <util/data_io.hpp>
 
 #define REGION_FORMAT_MAGIC ".VOXREG"
 
-regfile::regfile(fs::path filename) : file(std::move(filename)) {
+static debug::Logger logger("world-regions");
+
+/**
+  Region file format 4:
+    - byte-order: big-endian
+
+    ```cpp
+    char magic[8] = ".VOXREG";
+    uint8_t version = 4;
+    uint8_t compression; // compression::Method, 0 - layer default
+    struct {
+        uint32_t offset; // 0 if chunk is not stored
+        uint32_t size;
+        uint32_t checksum; // crc32 of the chunk data
+    } table[REGION_CHUNKS_COUNT];
+    // chunks data starting from REGION_DATA_OFFSET,
+    // every chunk occupies a run of REGION_SECTOR_SIZE sectors
+    ```
+
+  Format 3 has no checksum in the chunks table entries.
+
+  Format 2 has chunks data stored right after the header with uint32_t
+  size prefix and offsets table (uint32_t only) at the end of the file.
+
+  Chunks data of layers with unlimited data length (inventories, entities)
+  is prefixed with uint32_t uncompressed length if compressed.
+*/
+static inline uint get_entry_size(int version) {
+    if (version >= 4) {
+        return REGION_ENTRY_SIZE;
+    }
+    return version == 3 ? 8 : 4;
+}
+
+/// @brief Offset of the first data sector (format 3+)
+static inline size_t get_data_offset(int version) {
+    size_t tableEnd =
+        REGION_HEADER_SIZE + REGION_CHUNKS_COUNT * get_entry_size(version);
+    return (tableEnd + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE *
+           REGION_SECTOR_SIZE;
+}
+
+regfile::regfile(const fs::path& filename, compression::Method defaultMethod)
+    : file(filename) {
     if (file.length() < REGION_HEADER_SIZE)
         throw std::runtime_error("incomplete region file header");
-    char header[REGION_HEADER_SIZE];
-    file.read(header, REGION_HEADER_SIZE);
+    auto header = reinterpret_cast<const char*>(file.getData());
 
     // avoid of use strcmp_s
     if (std::string(header, strlen(REGION_FORMAT_MAGIC)) !=
@@ -30,45 +78,114 @@ regfile::regfile(fs::path filename) : file(std::move(filename)) {
             "region format " + std::to_string(version) + " is not supported"
         );
     }
+    uint entrySize = get_entry_size(version);
+    if (file.length() < REGION_HEADER_SIZE + REGION_CHUNKS_COUNT * entrySize) {
+        throw illegal_region_format("incomplete region offsets table");
+    }
+    ubyte methodId = header[9];
+    if (methodId == 0) {
+        compression = defaultMethod;
+    } else if (compression::is_valid(methodId)) {
+        compression = static_cast<compression::Method>(methodId);
+    } else {
+        throw illegal_region_format(
+            "unknown compression method " + std::to_string(methodId)
+        );
+    }
+}
+
+regentry regfile::readEntry(int index) const {
+    const ubyte* data = file.getData();
+    size_t entry_offset = REGION_HEADER_SIZE + index * get_entry_size(version);
+    regentry entry {
+        static_cast<uint32_t>(dataio::read_int32_big(data, entry_offset)),
+        static_cast<uint32_t>(dataio::read_int32_big(data, entry_offset + 4)),
+        0};
+    if (version >= 4) {
+        entry.checksum = static_cast<uint32_t>(
+            dataio::read_int32_big(data, entry_offset + 8)
+        );
+    }
+    return entry;
 }
 
-std::unique_ptr<ubyte[]> regfile::read(int index, uint32_t& length) {
+regentry regfile::getEntry(int index) const {
+    const ubyte* data = file.getData();
     size_t file_size = file.length();
+    if (version >= 3) {
+        regentry entry = readEntry(index);
+        if (entry.offset &&
+            static_cast<size_t>(entry.offset) + entry.size > file_size) {
+            throw illegal_region_format("chunk data is out of bounds");
+        }
+        return entry;
+    }
     size_t table_offset = file_size - REGION_CHUNKS_COUNT * 4;
 
-    uint32_t offset;
-    file.seekg(table_offset + index * 4);
-    file.read(reinterpret_cast<char*>(&offset), 4);
-    offset = dataio::read_int32_big(reinterpret_cast<const ubyte*>(&offset), 0);
+    uint32_t offset = dataio::read_int32_big(data, table_offset + index * 4);
     if (offset == 0) {
-        return nullptr;
+        return regentry {0, 0, 0};
+    }
+    if (offset + 4 > table_offset) {
+        throw illegal_region_format("chunk offset is out of bounds");
+    }
+    uint32_t length = dataio::read_int32_big(data, offset);
+    if (static_cast<size_t>(offset) + 4 + length > table_offset) {
+        throw illegal_region_format("chunk data is out of bounds");
     }
+    return regentry {offset + 4, length, 0};
+}
 
-    file.seekg(offset);
-    file.read(reinterpret_cast<char*>(&offset), 4);
-    length = dataio::read_int32_big(reinterpret_cast<const ubyte*>(&offset), 0);
-    auto data = std::make_unique<ubyte[]>(length);
-    file.read(reinterpret_cast<char*>(data.get()), length);
-    return data;
+const ubyte* regfile::read(int index, uint32_t& length) const {
+    auto entry = getEntry(index);
+    if (entry.offset == 0) {
+        return nullptr;
+    }
+    length = entry.size;
+    return file.getData() + entry.offset;
 }
 
 WorldRegion::WorldRegion()
     : chunksData(
-          std::make_unique<std::unique_ptr<ubyte[]>[]>(REGION_CHUNKS_COUNT)
+          std::make_unique<std::shared_ptr<ubyte[]>[]>(REGION_CHUNKS_COUNT)
       ),
-      sizes(std::make_unique<uint32_t[]>(REGION_CHUNKS_COUNT)) {
+      sizes(std::make_unique<uint32_t[]>(REGION_CHUNKS_COUNT)),
+      methods(std::make_unique<compression::Method[]>(REGION_CHUNKS_COUNT)),
+      versions(std::make_unique<uint32_t[]>(REGION_CHUNKS_COUNT)) {
 }
 
 WorldRegion::~WorldRegion() = default;
 
-void WorldRegion::setUnsaved(bool unsaved) {
-    this->unsaved = unsaved;
+std::unique_ptr<WorldRegion> WorldRegion::clone() const {
+    auto region = std::make_unique<WorldRegion>();
+    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        region->chunksData[i] = chunksData[i];
+        region->sizes[i] = sizes[i];
+        region->methods[i] = methods[i];
+        region->versions[i] = versions[i];
+    }
+    region->unsavedChunks = unsavedChunks;
+    region->dataSize = dataSize;
+    return region;
+}
+
+void WorldRegion::setSaved() {
+    unsavedChunks.reset();
 }
+
 bool WorldRegion::isUnsaved() const {
-    return unsaved;
+    return unsavedChunks.any();
+}
+
+bool WorldRegion::isChunkUnsaved(uint x, uint z) const {
+    return unsavedChunks.test(z * REGION_SIZE + x);
 }
 
-std::unique_ptr<ubyte[]>* WorldRegion::getChunks() const {
+void WorldRegion::setChunkUnsaved(uint x, uint z) {
+    unsavedChunks.set(z * REGION_SIZE + x);
+}
+
+std::shared_ptr<ubyte[]>* WorldRegion::getChunks() const {
     return chunksData.get();
 }
 
@@ -76,21 +193,64 @@ uint32_t* WorldRegion::getSizes() const {
     return sizes.get();
 }
 
-void WorldRegion::put(uint x, uint z, ubyte* data, uint32_t size) {
+compression::Method* WorldRegion::getMethods() const {
+    return methods.get();
+}
+
+void WorldRegion::put(
+    uint x,
+    uint z,
+    std::shared_ptr<ubyte[]> data,
+    uint32_t size,
+    compression::Method method
+) {
     size_t chunk_index = z * REGION_SIZE + x;
-    chunksData[chunk_index].reset(data);
-    sizes[chunk_index] = size;
+    replace(chunk_index, std::move(data), size, method);
+    versions[chunk_index]++;
+    unsavedChunks.set(chunk_index);
+}
+
+void WorldRegion::replace(
+    size_t index,
+    std::shared_ptr<ubyte[]> data,
+    uint32_t size,
+    compression::Method method
+) {
+    if (chunksData[index]) {
+        dataSize -= sizes[index];
+    }
+    chunksData[index] = std::move(data);
+    sizes[index] = size;
+    methods[index] = method;
+    if (chunksData[index]) {
+        dataSize += size;
+    }
+}
+
+size_t WorldRegion::getDataSize() const {
+    return dataSize;
 }
 
-ubyte* WorldRegion::getChunkData(uint x, uint z) {
-    return chunksData[z * REGION_SIZE + x].get();
+const std::shared_ptr<ubyte[]>& WorldRegion::getChunkData(
+    uint x, uint z
+) const {
+    return chunksData[z * REGION_SIZE + x];
 }
 
-uint WorldRegion::getChunkDataSize(uint x, uint z) {
+uint WorldRegion::getChunkDataSize(uint x, uint z) const {
     return sizes[z * REGION_SIZE + x];
 }
 
-WorldRegions::WorldRegions(const fs::path& directory) : directory(directory) {
+compression::Method WorldRegion::getChunkCompression(uint x, uint z) const {
+    return methods[z * REGION_SIZE + x];
+}
+
+uint32_t WorldRegion::getChunkVersion(uint x, uint z) const {
+    return versions[z * REGION_SIZE + x];
+}
+
+WorldRegions::WorldRegions(const fs::path& directory)
+    : directory(directory), journal(directory / fs::path("journal.bin")) {
     for (size_t i = 0; i < sizeof(layers) / sizeof(RegionsLayer); i++) {
         layers[i].layer = i;
     }
@@ -99,9 +259,95 @@ WorldRegions::WorldRegions(const fs::path& directory) : directory(directory) {
     layers[REGION_LAYER_INVENTORIES].folder =
         directory / fs::path("inventories");
     layers[REGION_LAYER_ENTITIES].folder = directory / fs::path("entities");
+
+    layers[REGION_LAYER_VOXELS].maxDataLength = CHUNK_DATA_LEN;
+    layers[REGION_LAYER_LIGHTS].maxDataLength = LIGHTMAP_DATA_LEN;
+
+    using compression::Method;
+    // methods used before compression method was stored in region files
+    layers[REGION_LAYER_VOXELS].defaultCompression = Method::EXTRLE;
+    layers[REGION_LAYER_LIGHTS].defaultCompression = Method::EXTRLE;
+    layers[REGION_LAYER_INVENTORIES].defaultCompression = Method::NONE;
+    layers[REGION_LAYER_ENTITIES].defaultCompression = Method::NONE;
+
+    layers[REGION_LAYER_VOXELS].compression = Method::EXTRLE;
+    layers[REGION_LAYER_LIGHTS].compression = Method::EXTRLE;
+    layers[REGION_LAYER_INVENTORIES].compression = Method::DEFLATE;
+    layers[REGION_LAYER_ENTITIES].compression = Method::DEFLATE;
+
+    writerThread = std::thread(&WorldRegions::runWriter, this);
+    prefetchThread = std::thread(&WorldRegions::runPrefetcher, this);
 }
 
-WorldRegions::~WorldRegions() = default;
+WorldRegions::~WorldRegions() {
+    {
+        std::lock_guard lock(prefetchMutex);
+        prefetchStopped = true;
+    }
+    prefetchCv.notify_all();
+    // queued prefetches are dropped
+    prefetchThread.join();
+    {
+        std::lock_guard lock(tasksMutex);
+        stopped = true;
+    }
+    tasksCv.notify_all();
+    // queued tasks are finished before the thread exits
+    writerThread.join();
+}
+
+void WorldRegions::pushTask(std::function<void()> task) {
+    {
+        std::lock_guard lock(tasksMutex);
+        tasks.push(std::move(task));
+    }
+    tasksCv.notify_one();
+}
+
+void WorldRegions::runWriter() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(tasksMutex);
+            tasksCv.wait(lock, [this]() { return stopped || !tasks.empty(); });
+            if (tasks.empty()) {
+                return;
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+void WorldRegions::runPrefetcher() {
+    while (true) {
+        glm::ivec2 key;
+        {
+            std::unique_lock lock(prefetchMutex);
+            prefetchCv.wait(lock, [this]() {
+                return prefetchStopped || !prefetchTasks.empty();
+            });
+            if (prefetchStopped) {
+                return;
+            }
+            key = prefetchTasks.front();
+            prefetchTasks.pop();
+        }
+        try {
+            for (uint layer = 0; layer < REGION_LAYERS_COUNT; layer++) {
+                if (auto file = getRegFile(glm::ivec3(key, layer))) {
+                    file.get()->file.prefetch();
+                }
+            }
+        } catch (const std::exception& err) {
+            logger.error() << "could not prefetch region " << key.x << ", "
+                           << key.y << ": " << err.what();
+        }
+        std::lock_guard lock(regFilesMutex);
+        prefetchQueue.erase(key);
+    }
+}
 
 WorldRegion* WorldRegions::getRegion(int x, int z, int layer) {
     RegionsLayer& regions = layers[layer];
@@ -113,40 +359,146 @@ WorldRegion* WorldRegions::getRegion(int x, int z, int layer) {
     return found->second.get();
 }
 
-WorldRegion* WorldRegions::getOrCreateRegion(int x, int z, int layer) {
-    if (auto region = getRegion(x, z, layer)) {
-        return region;
-    }
-    RegionsLayer& regions = layers[layer];
-    std::lock_guard lock(regions.mutex);
-    auto region_ptr = std::make_unique<WorldRegion>();
-    auto region = region_ptr.get();
-    regions.regions[{x, z}] = std::move(region_ptr);
-    return region;
+void WorldRegions::setCompression(
+    int layer, compression::Method method, int level
+) {
+    layers[layer].compression = method;
+    layers[layer].compressionLevel = level;
 }
 
 std::unique_ptr<ubyte[]> WorldRegions::compress(
-    const ubyte* src, size_t srclen, size_t& len
+    const ubyte* src, size_t srclen, size_t& len, int layer
 ) {
-    auto buffer = bufferPool.get();
-    auto bytes = buffer.get();
+    const auto& regions = layers[layer];
+    auto method = regions.compression;
+    size_t prefix = 0;
+    if (regions.maxDataLength == 0 && method != compression::Method::NONE) {
+        prefix = sizeof(uint32_t);
+    }
+    size_t required = prefix + compression::bound(srclen, method);
 
-    len = extrle::encode(src, srclen, bytes);
-    auto data = std::make_unique<ubyte[]>(len);
-    for (size_t i = 0; i < len; i++) {
-        data[i] = bytes[i];
+    std::shared_ptr<ubyte[]> buffer;
+    if (required <= bufferPool.getBufferSize()) {
+        buffer = bufferPool.get();
+    } else {
+        buffer = std::make_unique<ubyte[]>(required);
+    }
+    auto bytes = buffer.get();
+    if (prefix) {
+        dataio::write_int32_big(srclen, bytes, 0);
     }
+    len = prefix + compression::compress(
+                       src,
+                       srclen,
+                       bytes + prefix,
+                       method,
+                       regions.compressionLevel
+                   );
+    auto data = std::make_unique<ubyte[]>(len);
+    std::memcpy(data.get(), bytes, len);
     return data;
 }
 
 std::unique_ptr<ubyte[]> WorldRegions::decompress(
-    const ubyte* src, size_t srclen, size_t dstlen
+    const ubyte* src,
+    size_t srclen,
+    size_t& len,
+    int layer,
+    compression::Method method
 ) {
+    size_t dstlen = layers[layer].maxDataLength;
+    if (dstlen == 0) {
+        dstlen = srclen;
+        if (method != compression::Method::NONE) {
+            if (srclen < sizeof(uint32_t)) {
+                throw illegal_region_format("incomplete chunk data");
+            }
+            dstlen = static_cast<uint32_t>(dataio::read_int32_big(src, 0));
+            if (dstlen > REGION_MAX_DATA_LENGTH) {
+                throw illegal_region_format(
+                    "chunk data length is out of bounds"
+                );
+            }
+            src += sizeof(uint32_t);
+            srclen -= sizeof(uint32_t);
+        }
+    }
     auto decompressed = std::make_unique<ubyte[]>(dstlen);
-    extrle::decode(src, srclen, decompressed.get());
+    len = compression::decompress(
+        src, srclen, decompressed.get(), dstlen, method
+    );
     return decompressed;
 }
 
+std::unique_ptr<ubyte[]> WorldRegions::recompress(
+    const ubyte* src,
+    size_t srclen,
+    size_t& len,
+    int layer,
+    compression::Method method
+) {
+    if (method == compression::Method::NONE) {
+        return compress(src, srclen, len, layer);
+    }
+    size_t length;
+    auto data = decompress(src, srclen, length, layer, method);
+    return compress(data.get(), length, len, layer);
+}
+
+void WorldRegions::updateChunkData(
+    int x,
+    int z,
+    int layer,
+    size_t index,
+    const std::shared_ptr<ubyte[]>& expected,
+    std::shared_ptr<ubyte[]> data,
+    uint32_t size
+) {
+    auto& regions = layers[layer];
+    std::lock_guard lock(regions.mutex);
+    const auto& found = regions.regions.find(glm::ivec2(x, z));
+    if (found == regions.regions.end()) {
+        return;
+    }
+    auto region = found->second.get();
+    if (region->getChunks()[index] != expected) {
+        return;
+    }
+    size_t prevSize = region->getDataSize();
+    region->replace(index, std::move(data), size, regions.compression);
+    cachedBytes += region->getDataSize();
+    cachedBytes -= prevSize;
+}
+
+void WorldRegions::finishWrite(
+    int x, int z, int layer, const WorldRegion* snapshot, bool success
+) {
+    auto& regions = layers[layer];
+    std::lock_guard lock(regions.mutex);
+    const auto& found = regions.regions.find(glm::ivec2(x, z));
+    if (found == regions.regions.end()) {
+        return;
+    }
+    auto region = found->second.get();
+    region->pendingWrites--;
+    if (success) {
+        return;
+    }
+    for (uint cz = 0; cz < REGION_SIZE; cz++) {
+        for (uint cx = 0; cx < REGION_SIZE; cx++) {
+            // data may be replaced by recompression, so versions are
+            // compared instead of buffers
+            if (snapshot->isChunkUnsaved(cx, cz) &&
+                region->getChunkVersion(cx, cz) ==
+                    snapshot->getChunkVersion(cx, cz)) {
+                region->setChunkUnsaved(cx, cz);
+            }
+        }
+    }
+    // counted after chunks are marked unsaved to be captured by writeAsync
+    failedWrites++;
+}
+
 inline void calc_reg_coords(
     int x, int z, int& regionX, int& regionZ, int& localX, int& localZ
 ) {
@@ -162,197 +514,507 @@ std::unique_ptr<ubyte[]> WorldRegions::readChunkData(
     int regionX, regionZ, localX, localZ;
     calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
     int chunkIndex = localZ * REGION_SIZE + localX;
-    return rfile->read(chunkIndex, length);
+    const ubyte* mapped = rfile->read(chunkIndex, length);
+    if (mapped == nullptr) {
+        return nullptr;
+    }
+    auto data = std::make_unique<ubyte[]>(length);
+    std::memcpy(data.get(), mapped, length);
+    return data;
 }
 
-/// @brief Read missing chunks data (null pointers) from region file
-void WorldRegions::fetchChunks(
-    WorldRegion* region, int x, int z, regfile* file
+size_t WorldRegions::fetchChunks(
+    WorldRegion* region, int x, int z, int layer, regfile* file
 ) {
     auto* chunks = region->getChunks();
     uint32_t* sizes = region->getSizes();
+    auto* methods = region->getMethods();
+    bool transcode = file->compression != layers[layer].compression;
 
+    size_t lost = 0;
     for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
         int chunk_x = (i % REGION_SIZE) + x * REGION_SIZE;
         int chunk_z = (i / REGION_SIZE) + z * REGION_SIZE;
-        if (chunks[i] == nullptr) {
+        if (chunks[i] != nullptr) {
+            continue;
+        }
+        try {
             chunks[i] = readChunkData(chunk_x, chunk_z, sizes[i], file);
+            methods[i] = layers[layer].compression;
+            if (chunks[i] && transcode) {
+                size_t compressedSize;
+                chunks[i] = recompress(
+                    chunks[i].get(),
+                    sizes[i],
+                    compressedSize,
+                    layer,
+                    file->compression
+                );
+                sizes[i] = compressedSize;
+            }
+        } catch (const std::runtime_error& err) {
+            logger.error() << "could not read chunk " << chunk_x << ", "
+                           << chunk_z << ": " << err.what();
+            chunks[i] = nullptr;
+            lost++;
         }
     }
+    return lost;
 }
 
-ubyte* WorldRegions::getData(int x, int z, int layer, uint32_t& size) {
+regdata WorldRegions::getData(int x, int z, int layer) {
+    regdata result;
     if (generatorTestMode) {
-        return nullptr;
+        return result;
     }
     int regionX, regionZ, localX, localZ;
     calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
 
-    WorldRegion* region = getOrCreateRegion(regionX, regionZ, layer);
-    ubyte* data = region->getChunkData(localX, localZ);
-    if (data == nullptr) {
-        auto regfile = getRegFile(glm::ivec3(regionX, regionZ, layer));
-        if (regfile != nullptr) {
-            data = readChunkData(x, z, size, regfile.get()).release();
-        }
-        if (data != nullptr) {
-            region->put(localX, localZ, data, size);
+    {
+        auto& regions = layers[layer];
+        std::lock_guard lock(regions.mutex);
+        const auto& found = regions.regions.find({regionX, regionZ});
+        if (found != regions.regions.end()) {
+            auto region = found->second.get();
+            touchRegion(regions, region);
+            if (const auto& data = region->getChunkData(localX, localZ)) {
+                cacheHits++;
+                result.buffer = data;
+                result.data = data.get();
+                result.size = region->getChunkDataSize(localX, localZ);
+                result.compression =
+                    region->getChunkCompression(localX, localZ);
+                return result;
+            }
         }
     }
-    if (data != nullptr) {
-        size = region->getChunkDataSize(localX, localZ);
-        return data;
+    cacheMisses++;
+    auto regfile = getRegFile(glm::ivec3(regionX, regionZ, layer));
+    if (regfile == nullptr) {
+        return result;
+    }
+    int chunkIndex = localZ * REGION_SIZE + localX;
+    result.data = regfile.get()->read(chunkIndex, result.size);
+    if (result.data) {
+        result.compression = regfile.get()->compression;
+        result.file = std::move(regfile);
     }
-    return nullptr;
+    return result;
 }
 
-regfile_ptr WorldRegions::useRegFile(glm::ivec3 coord) {
-    auto* file = openRegFiles[coord].get();
-    file->inUse = true;
-    return regfile_ptr(file, &regFilesCv);
+regfile_ptr WorldRegions::useRegFile(regfile* file) {
+    file->users++;
+    file->lastUse = ++regFilesTicks;
+    return regfile_ptr(file, &regFilesMutex, &regFilesCv);
 }
 
 void WorldRegions::closeRegFile(glm::ivec3 coord) {
-    openRegFiles.erase(coord);
-    regFilesCv.notify_one();
+    const auto found = openRegFiles.find(coord);
+    if (found == openRegFiles.end()) {
+        return;
+    }
+    layers[coord[2]].mappedBytes -= found->second->file.length();
+    openRegFiles.erase(found);
+    regFilesCv.notify_all();
 }
 
-// Marks regfile as used and unmarks when shared_ptr dies
-regfile_ptr WorldRegions::getRegFile(glm::ivec3 coord, bool create) {
-    {
-        std::lock_guard lock(regFilesMutex);
-        const auto found = openRegFiles.find(coord);
-        if (found != openRegFiles.end()) {
-            if (found->second->inUse) {
-                throw std::runtime_error("regfile is currently in use");
+void WorldRegions::closeUnusedRegFiles() {
+    while (openRegFiles.size() > MAX_OPEN_REGION_FILES) {
+        auto victim = openRegFiles.end();
+        for (auto it = openRegFiles.begin(); it != openRegFiles.end(); ++it) {
+            if (it->second->users == 0 &&
+                (victim == openRegFiles.end() ||
+                 it->second->lastUse < victim->second->lastUse)) {
+                victim = it;
             }
-            return useRegFile(found->first);
         }
+        if (victim == openRegFiles.end()) {
+            return;
+        }
+        closeRegFile(victim->first);
     }
-    if (create) {
-        return createRegFile(coord);
-    }
-    return nullptr;
 }
 
-regfile_ptr WorldRegions::createRegFile(glm::ivec3 coord) {
+// Increments regfile users and decrements when regfile_ptr dies.
+// Waits only while the file is being written
+regfile_ptr WorldRegions::getRegFile(glm::ivec3 coord, bool create) {
+    std::unique_lock lock(regFilesMutex);
+    regFilesCv.wait(lock, [this, coord]() {
+        return writtenRegFiles.find(coord) == writtenRegFiles.end();
+    });
+    const auto found = openRegFiles.find(coord);
+    if (found != openRegFiles.end()) {
+        return useRegFile(found->second.get());
+    }
+    if (!create) {
+        return nullptr;
+    }
     fs::path file =
         layers[coord[2]].folder / getRegionFilename(coord[0], coord[1]);
     if (!fs::exists(file)) {
         return nullptr;
     }
-    if (openRegFiles.size() == MAX_OPEN_REGION_FILES) {
+    openRegFile(coord, file);
+    auto ptr = useRegFile(openRegFiles[coord].get());
+    closeUnusedRegFiles();
+    return ptr;
+}
+
+void WorldRegions::openRegFile(glm::ivec3 coord, const fs::path& file) {
+    auto rfile =
+        std::make_unique<regfile>(file, layers[coord[2]].defaultCompression);
+    layers[coord[2]].mappedBytes += rfile->file.length();
+    openRegFiles[coord] = std::move(rfile);
+}
+
+fs::path WorldRegions::getRegionFilename(int x, int z) const {
+    return fs::path(std::to_string(x) + "_" + std::to_string(z) + ".bin");
+}
+
+static inline size_t count_sectors(uint32_t size) {
+    return std::max<size_t>(
+        1, (static_cast<size_t>(size) + REGION_SECTOR_SIZE - 1) /
+               REGION_SECTOR_SIZE
+    );
+}
+
+static void mark_sectors(
+    std::vector<bool>& used, size_t start, size_t count, bool flag
+) {
+    if (used.size() < start + count) {
+        used.resize(start + count, false);
+    }
+    for (size_t i = start; i < start + count; i++) {
+        used[i] = flag;
+    }
+}
+
+/// @brief Find first free sectors run of the given length
+/// @return index of the first sector of the run (may be beyond the used
+/// vector end if the file should be extended)
+static size_t find_free_sectors(const std::vector<bool>& used, size_t count) {
+    size_t start = REGION_DATA_OFFSET / REGION_SECTOR_SIZE;
+    size_t run = 0;
+    for (size_t i = start; i < used.size(); i++) {
+        if (used[i]) {
+            run = 0;
+            start = i + 1;
+        } else if (++run == count) {
+            return start;
+        }
+    }
+    return start;
+}
+
+void WorldRegions::writeRegion(
+    int x,
+    int z,
+    int layer,
+    WorldRegion* entry,
+    compression::Method method,
+    bool compact
+) {
+    glm::ivec3 regcoord(x, z, layer);
+    {
         std::unique_lock lock(regFilesMutex);
+        // readers wait until the file is written
+        writtenRegFiles.insert(regcoord);
         while (true) {
-            bool closed = false;
-            // FIXME: bad choosing algorithm
-            for (auto& entry : openRegFiles) {
-                if (!entry.second->inUse) {
-                    closeRegFile(entry.first);
-                    closed = true;
-                    break;
-                }
+            const auto found = openRegFiles.find(regcoord);
+            if (found == openRegFiles.end()) {
+                break;
             }
-            if (closed) {
+            if (found->second->users == 0) {
+                closeRegFile(regcoord);
                 break;
             }
-            // notified when any regfile gets out of use or closed
             regFilesCv.wait(lock);
         }
-        openRegFiles[coord] = std::make_unique<regfile>(file);
-        return useRegFile(coord);
-    } else {
+    }
+    try {
+        writeRegionFile(x, z, layer, entry, method, compact);
+    } catch (...) {
+        {
+            std::lock_guard lock(regFilesMutex);
+            writtenRegFiles.erase(regcoord);
+        }
+        regFilesCv.notify_all();
+        throw;
+    }
+    {
         std::lock_guard lock(regFilesMutex);
-        openRegFiles[coord] = std::make_unique<regfile>(file);
-        return useRegFile(coord);
+        writtenRegFiles.erase(regcoord);
     }
+    regFilesCv.notify_all();
 }
 
-fs::path WorldRegions::getRegionFilename(int x, int z) const {
-    return fs::path(std::to_string(x) + "_" + std::to_string(z) + ".bin");
+/// @brief Move region file which could not be read completely out of the way
+static void rename_damaged(const fs::path& filename) {
+    fs::path damaged =
+        filename.parent_path() / ("damaged_" + filename.filename().u8string());
+    logger.error() << "region file " << filename.u8string()
+                   << " is damaged, moved to " << damaged.u8string();
+    fs::rename(filename, damaged);
 }
 
-void WorldRegions::writeRegion(int x, int z, int layer, WorldRegion* entry) {
-    fs::path filename = layers[layer].folder / getRegionFilename(x, z);
+std::unique_ptr<regentry[]> WorldRegions::readRegionTable(
+    int x,
+    int z,
+    int layer,
+    WorldRegion* entry,
+    compression::Method method,
+    const fs::path& filename
+) {
+    // the file is not cached as it's going to be modified
+    std::unique_ptr<regfile> file;
+    try {
+        file = std::make_unique<regfile>(
+            filename, layers[layer].defaultCompression
+        );
+    } catch (const std::runtime_error& err) {
+        logger.error() << err.what();
+        rename_damaged(filename);
+        return nullptr;
+    }
+    if (file->version != REGION_FORMAT_VERSION ||
+        file->compression != method) {
+        // older formats and other compression methods are converted
+        // with full rewrite
+        size_t lost = fetchChunks(entry, x, z, layer, file.get());
+        file.reset();
+        if (lost) {
+            rename_damaged(filename);
+        }
+        return nullptr;
+    }
+    auto* chunks = entry->getChunks();
+    auto table = std::make_unique<regentry[]>(REGION_CHUNKS_COUNT);
+    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        try {
+            table[i] = file->getEntry(i);
+        } catch (const illegal_region_format& err) {
+            uint localX = i % REGION_SIZE;
+            uint localZ = i / REGION_SIZE;
+            if (chunks[i] && entry->isChunkUnsaved(localX, localZ)) {
+                logger.error() << "region " << x << ", " << z << ": entry "
+                               << i << " is overwritten: " << err.what();
+                table[i] = {};
+            } else {
+                // keep the entry as is, the data may still be recovered
+                logger.error() << "region " << x << ", " << z << ": entry "
+                               << i << " is kept: " << err.what();
+                table[i] = file->readEntry(i);
+            }
+        }
+    }
+    return table;
+}
 
-    glm::ivec3 regcoord(x, z, layer);
-    if (auto regfile = getRegFile(regcoord, false)) {
-        fetchChunks(entry, x, z, regfile.get());
+void WorldRegions::writeRegionFile(
+    int x,
+    int z,
+    int layer,
+    WorldRegion* entry,
+    compression::Method method,
+    bool compact
+) {
+    fs::path filename = layers[layer].folder / getRegionFilename(x, z);
 
-        std::lock_guard lock(regFilesMutex);
-        regfile.reset();
-        closeRegFile(regcoord);
+    std::unique_ptr<regentry[]> table;
+    if (!compact && fs::exists(filename)) {
+        table = readRegionTable(x, z, layer, entry, method, filename);
     }
+    if (table) {
+        writeRegionData(x, z, layer, entry, method, filename, table.get());
+    } else {
+        // new file is written aside to not to lose the old one on failure
+        fs::path tmpfile =
+            filename.parent_path() / ("tmp_" + filename.filename().u8string());
+        fs::remove(tmpfile);
+        writeRegionData(x, z, layer, entry, method, tmpfile, nullptr);
+        fs::rename(tmpfile, filename);
+    }
+}
 
-    char header[REGION_HEADER_SIZE] = REGION_FORMAT_MAGIC;
-    header[8] = REGION_FORMAT_VERSION;
-    header[9] = 0;  // flags
-    std::ofstream file(filename, std::ios::out | std::ios::binary);
-    file.write(header, REGION_HEADER_SIZE);
+void WorldRegions::writeRegionData(
+    int x,
+    int z,
+    int layer,
+    WorldRegion* entry,
+    compression::Method method,
+    const fs::path& filename,
+    regentry* table
+) {
+    bool rewrite = table == nullptr;
+    regentry newTable[REGION_CHUNKS_COUNT] {};
+    if (rewrite) {
+        table = newTable;
+        char header[REGION_DATA_OFFSET] {};
+        std::memcpy(header, REGION_FORMAT_MAGIC, strlen(REGION_FORMAT_MAGIC));
+        header[8] = REGION_FORMAT_VERSION;
+        header[9] = static_cast<char>(method);
+        std::ofstream file(filename, std::ios::out | std::ios::binary);
+        file.write(header, REGION_DATA_OFFSET);
+        if (!file) {
+            throw std::runtime_error(
+                "could not write file " + filename.u8string()
+            );
+        }
+    }
+    size_t fileSectors =
+        (fs::file_size(filename) + REGION_SECTOR_SIZE - 1) / REGION_SECTOR_SIZE;
 
-    size_t offset = REGION_HEADER_SIZE;
-    char intbuf[4] {};
-    uint offsets[REGION_CHUNKS_COUNT] {};
+    std::vector<bool> used;
+    mark_sectors(used, 0, REGION_DATA_OFFSET / REGION_SECTOR_SIZE, true);
+    for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        const auto& chunkEntry = table[i];
+        size_t sector = chunkEntry.offset / REGION_SECTOR_SIZE;
+        if (chunkEntry.offset && sector < fileSectors) {
+            // damaged entries may point beyond the end of file
+            mark_sectors(
+                used,
+                sector,
+                std::min(count_sectors(chunkEntry.size), fileSectors - sector),
+                true
+            );
+        }
+    }
 
+    std::fstream file(
+        filename, std::ios::in | std::ios::out | std::ios::binary
+    );
+    if (!file) {
+        throw std::runtime_error(
+            "could not to open file " + filename.u8string()
+        );
+    }
     auto* region = entry->getChunks();
     uint32_t* sizes = entry->getSizes();
+    auto* methods = entry->getMethods();
 
     for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
-        ubyte* chunk = region[i].get();
-        if (chunk == nullptr) {
-            offsets[i] = 0;
-        } else {
-            offsets[i] = offset;
-
-            size_t compressedSize = sizes[i];
-            dataio::write_int32_big(
-                compressedSize, reinterpret_cast<ubyte*>(intbuf), 0
+        auto& chunk = region[i];
+        if (chunk == nullptr ||
+            !(rewrite ||
+              entry->isChunkUnsaved(i % REGION_SIZE, i / REGION_SIZE))) {
+            continue;
+        }
+        if (methods[i] != method) {
+            // captured before compressed in background
+            size_t compressedSize;
+            std::shared_ptr<ubyte[]> compressed = recompress(
+                chunk.get(), sizes[i], compressedSize, layer, methods[i]
             );
-            offset += 4 + compressedSize;
-
-            file.write(intbuf, 4);
-            file.write(reinterpret_cast<const char*>(chunk), compressedSize);
+            updateChunkData(x, z, layer, i, chunk, compressed, compressedSize);
+            chunk = std::move(compressed);
+            sizes[i] = compressedSize;
+            methods[i] = method;
         }
+        // previously occupied sectors are not reused until the new table
+        // is written, so the old chunk stays readable if writing fails
+        size_t required = count_sectors(sizes[i]);
+        size_t sector = find_free_sectors(used, required);
+        mark_sectors(used, sector, required, true);
+
+        auto& chunkEntry = table[i];
+        chunkEntry.offset = sector * REGION_SECTOR_SIZE;
+        chunkEntry.size = sizes[i];
+        chunkEntry.checksum = crc32(0L, chunk.get(), sizes[i]);
+
+        file.seekp(chunkEntry.offset);
+        file.write(reinterpret_cast<const char*>(chunk.get()), sizes[i]);
     }
+    file.flush();
+    files::sync(filename);
+
+    ubyte tableBytes[REGION_CHUNKS_COUNT * REGION_ENTRY_SIZE];
     for (size_t i = 0; i < REGION_CHUNKS_COUNT; i++) {
         dataio::write_int32_big(
-            offsets[i], reinterpret_cast<ubyte*>(intbuf), 0
+            table[i].offset, tableBytes, i * REGION_ENTRY_SIZE
+        );
+        dataio::write_int32_big(
+            table[i].size, tableBytes, i * REGION_ENTRY_SIZE + 4
+        );
+        dataio::write_int32_big(
+            table[i].checksum, tableBytes, i * REGION_ENTRY_SIZE + 8
+        );
+    }
+    file.seekp(REGION_HEADER_SIZE);
+    file.write(reinterpret_cast<const char*>(tableBytes), sizeof(tableBytes));
+    file.flush();
+    if (!file) {
+        throw std::runtime_error(
+            "could not write file " + filename.u8string()
         );
-        file.write(intbuf, 4);
     }
+    files::sync(filename);
 }
 
-void WorldRegions::writeRegions(int layer) {
-    for (auto& it : layers[layer].regions) {
-        WorldRegion* region = it.second.get();
-        if (region->getChunks() == nullptr || !region->isUnsaved()) {
-            continue;
-        }
-        glm::ivec2 key = it.first;
-        writeRegion(key[0], key[1], layer, region);
+void WorldRegions::put(
+    int x, int z, int layer, std::unique_ptr<ubyte[]> data, size_t size
+) {
+    std::shared_ptr<ubyte[]> buffer(std::move(data));
+    if (journaling) {
+        std::lock_guard lock(journalMutex);
+        journalQueue[glm::ivec3(x, z, layer)] = {
+            buffer, static_cast<uint32_t>(size)};
     }
+    store(x, z, layer, std::move(buffer), size);
 }
 
-void WorldRegions::put(
+void WorldRegions::store(
     int x,
     int z,
     int layer,
-    std::unique_ptr<ubyte[]> data,
+    std::shared_ptr<ubyte[]> buffer,
     size_t size,
-    bool rle
+    compression::Method method
 ) {
-    if (rle) {
-        size_t compressedSize;
-        auto compressed = compress(data.get(), size, compressedSize);
-        put(x, z, layer, std::move(compressed), compressedSize, false);
-        return;
-    }
     int regionX, regionZ, localX, localZ;
     calc_reg_coords(x, z, regionX, regionZ, localX, localZ);
 
-    WorldRegion* region = getOrCreateRegion(regionX, regionZ, layer);
-    region->setUnsaved(true);
-    region->put(localX, localZ, data.release(), size);
+    auto& regions = layers[layer];
+    {
+        std::lock_guard lock(regions.mutex);
+        glm::ivec2 key(regionX, regionZ);
+        auto& region = regions.regions[key];
+        if (region == nullptr) {
+            region = std::make_unique<WorldRegion>();
+            region->lruPosition = regions.lru.insert(regions.lru.end(), key);
+        }
+        size_t prevSize = region->getDataSize();
+        region->put(localX, localZ, buffer, size, method);
+        touchRegion(regions, region.get());
+        cachedBytes += region->getDataSize();
+        cachedBytes -= prevSize;
+    }
+    if (cachedBytes > maxCachedBytes) {
+        evictRegions();
+    }
+    if (method != compression::Method::NONE ||
+        regions.compression == compression::Method::NONE) {
+        return;
+    }
+    size_t index = localZ * REGION_SIZE + localX;
+    pushTask([=]() {
+        try {
+            size_t compressedSize;
+            std::shared_ptr<ubyte[]> compressed =
+                compress(buffer.get(), size, compressedSize, layer);
+            updateChunkData(
+                regionX,
+                regionZ,
+                layer,
+                index,
+                buffer,
+                std::move(compressed),
+                compressedSize
+            );
+        } catch (const std::exception& err) {
+            logger.error() << "could not compress chunk " << x << ", " << z
+                           << ": " << err.what();
+        }
+    });
 }
 
 static std::unique_ptr<ubyte[]> write_inventories(
@@ -364,7 +1026,7 @@ static std::unique_ptr<ubyte[]> write_inventories(
     for (auto& entry : inventories) {
         builder.putInt32(entry.first);
         auto map = entry.second->serialize();
-        auto bytes = json::to_binary(map.get(), true);
+        auto bytes = json::to_binary(map.get(), false);
         builder.putInt32(bytes.size());
         builder.put(bytes.data(), bytes.size());
     }
@@ -389,32 +1051,35 @@ void WorldRegions::put(Chunk* chunk, std::vector<ubyte> entitiesData) {
     int regionX, regionZ, localX, localZ;
     calc_reg_coords(chunk->x, chunk->z, regionX, regionZ, localX, localZ);
 
+    size_t voxelsSize = CHUNK_DATA_LEN;
+    auto voxels = paletteVoxels ? chunk->encodePalette(voxelsSize)
+                                : chunk->encode();
     put(chunk->x,
         chunk->z,
         REGION_LAYER_VOXELS,
-        chunk->encode(),
-        CHUNK_DATA_LEN,
-        true);
+        std::move(voxels),
+        voxelsSize);
 
     // Writing lights cache
     if (doWriteLights && chunk->flags.lighted) {
+        size_t lightsSize;
+        auto lights = chunk->lightmap.encode(lightsSize);
         put(chunk->x,
             chunk->z,
             REGION_LAYER_LIGHTS,
-            chunk->lightmap.encode(),
-            LIGHTMAP_DATA_LEN,
-            true);
+            std::move(lights),
+            lightsSize);
     }
-    // Writing block inventories
-    if (!chunk->inventories.empty()) {
+    // Writing block inventories (empty record replaces cleared ones)
+    if (!chunk->inventories.empty() || chunk->flags.inventories) {
         uint datasize;
         auto data = write_inventories(chunk, datasize);
         put(chunk->x,
             chunk->z,
             REGION_LAYER_INVENTORIES,
             std::move(data),
-            datasize,
-            false);
+            datasize);
+        chunk->flags.inventories = !chunk->inventories.empty();
     }
     // Writing entities
     if (!entitiesData.empty()) {
@@ -426,40 +1091,51 @@ void WorldRegions::put(Chunk* chunk, std::vector<ubyte> entitiesData) {
             chunk->z,
             REGION_LAYER_ENTITIES,
             std::move(data),
-            entitiesData.size(),
-            false);
+            entitiesData.size());
     }
 }
 
-std::unique_ptr<ubyte[]> WorldRegions::getChunk(int x, int z) {
-    uint32_t size;
-    auto* data = getData(x, z, REGION_LAYER_VOXELS, size);
-    if (data == nullptr) {
+std::unique_ptr<ubyte[]> WorldRegions::getChunk(
+    int x, int z, size_t& length
+) {
+    auto data = getData(x, z, REGION_LAYER_VOXELS);
+    if (!data) {
         return nullptr;
     }
-    return decompress(data, size, CHUNK_DATA_LEN);
+    return decompress(
+        data.data, data.size, length, REGION_LAYER_VOXELS, data.compression
+    );
 }
 
 /// @brief Get cached lights for chunk at x,z
 /// @return lights data or nullptr
 std::unique_ptr<light_t[]> WorldRegions::getLights(int x, int z) {
-    uint32_t size;
-    auto* bytes = getData(x, z, REGION_LAYER_LIGHTS, size);
-    if (bytes == nullptr) {
+    auto bytes = getData(x, z, REGION_LAYER_LIGHTS);
+    if (!bytes) {
         return nullptr;
     }
-    auto data = decompress(bytes, size, LIGHTMAP_DATA_LEN);
-    return Lightmap::decode(data.get());
+    size_t length;
+    auto data = decompress(
+        bytes.data, bytes.size, length, REGION_LAYER_LIGHTS, bytes.compression
+    );
+    return Lightmap::decode(data.get(), length);
 }
 
 chunk_inventories_map WorldRegions::fetchInventories(int x, int z) {
     chunk_inventories_map meta;
-    uint32_t bytesSize;
-    const ubyte* data = getData(x, z, REGION_LAYER_INVENTORIES, bytesSize);
-    if (data == nullptr) {
+    auto data = getData(x, z, REGION_LAYER_INVENTORIES);
+    if (!data) {
         return meta;
     }
-    ByteReader reader(data, bytesSize);
+    size_t length;
+    auto bytes = decompress(
+        data.data,
+        data.size,
+        length,
+        REGION_LAYER_INVENTORIES,
+        data.compression
+    );
+    ByteReader reader(bytes.get(), length);
     auto count = reader.getInt32();
     for (int i = 0; i < count; i++) {
         uint index = reader.getInt32();
@@ -474,57 +1150,515 @@ chunk_inventories_map WorldRegions::fetchInventories(int x, int z) {
 }
 
 dynamic::Map_sptr WorldRegions::fetchEntities(int x, int z) {
-    uint32_t bytesSize;
-    const ubyte* data = getData(x, z, REGION_LAYER_ENTITIES, bytesSize);
-    if (data == nullptr) {
+    auto data = getData(x, z, REGION_LAYER_ENTITIES);
+    if (!data) {
         return nullptr;
     }
-    auto map = json::from_binary(data, bytesSize);
+    size_t length;
+    auto bytes = decompress(
+        data.data, data.size, length, REGION_LAYER_ENTITIES, data.compression
+    );
+    auto map = json::from_binary(bytes.get(), length);
     if (map->size() == 0) {
         return nullptr;
     }
     return map;
 }
 
-void WorldRegions::processRegionVoxels(int x, int z, const regionproc& func) {
-    if (getRegion(x, z, REGION_LAYER_VOXELS)) {
-        throw std::runtime_error("not implemented for in-memory regions");
+void WorldRegions::flushRegion(int x, int z, int layer) {
+    if (getRegion(x, z, layer) == nullptr) {
+        return;
     }
-    auto regfile = getRegFile(glm::ivec3(x, z, REGION_LAYER_VOXELS));
-    if (regfile == nullptr) {
-        throw std::runtime_error("could not open region file");
+    // also waits for the region writes queued before
+    write();
+
+    auto& regions = layers[layer];
+    std::lock_guard lock(regions.mutex);
+    const auto& found = regions.regions.find(glm::ivec2(x, z));
+    if (found == regions.regions.end()) {
+        return;
     }
-    for (uint cz = 0; cz < REGION_SIZE; cz++) {
-        for (uint cx = 0; cx < REGION_SIZE; cx++) {
-            int gx = cx + x * REGION_SIZE;
-            int gz = cz + z * REGION_SIZE;
-            uint32_t length;
-            auto data = readChunkData(gx, gz, length, regfile.get());
-            if (data == nullptr) {
+    auto region = found->second.get();
+    if (region->isUnsaved() || region->pendingWrites) {
+        throw std::runtime_error("region is modified while being processed");
+    }
+    cachedBytes -= region->getDataSize();
+    regions.lru.erase(region->lruPosition);
+    regions.regions.erase(found);
+}
+
+void WorldRegions::processRegion(
+    int x, int z, int layer, const regionproc& func
+) {
+    flushRegion(x, z, layer);
+    // modified chunks only, the rest is kept in the file
+    WorldRegion region;
+    {
+        auto regfile = getRegFile(glm::ivec3(x, z, layer));
+        if (regfile == nullptr) {
+            throw std::runtime_error("could not open region file");
+        }
+        for (uint cz = 0; cz < REGION_SIZE; cz++) {
+            for (uint cx = 0; cx < REGION_SIZE; cx++) {
+                uint32_t length;
+                const ubyte* mapped =
+                    regfile.get()->read(cz * REGION_SIZE + cx, length);
+                if (mapped == nullptr) {
+                    continue;
+                }
+                size_t size;
+                auto data = decompress(
+                    mapped, length, size, layer, regfile.get()->compression
+                );
+                if (!func(data, size)) {
+                    continue;
+                }
+                size_t compressedSize;
+                auto compressed =
+                    compress(data.get(), size, compressedSize, layer);
+                region.put(
+                    cx,
+                    cz,
+                    std::move(compressed),
+                    compressedSize,
+                    layers[layer].compression
+                );
+            }
+        }
+    }
+    if (region.isUnsaved()) {
+        writeRegion(x, z, layer, &region, layers[layer].compression);
+    }
+}
+
+/// @brief Check decompressed chunk data can be decoded
+static bool check_chunk_data(
+    int layer, const ubyte* data, size_t length, Chunk& chunk
+) {
+    switch (layer) {
+        case REGION_LAYER_VOXELS:
+            return chunk.decode(data, length);
+        case REGION_LAYER_LIGHTS:
+            return Lightmap::decode(data, length) != nullptr;
+        default:
+            return true;
+    }
+}
+
+regioncheck WorldRegions::checkRegion(int x, int z, int layer) {
+    regioncheck result;
+    fs::path filename = layers[layer].folder / getRegionFilename(x, z);
+    result.fileSize = fs::file_size(filename);
+
+    regfile_ptr rfile = nullptr;
+    try {
+        rfile = getRegFile(glm::ivec3(x, z, layer));
+    } catch (const std::exception& err) {
+        result.errors.push_back(err.what());
+        return result;
+    }
+    if (rfile == nullptr) {
+        result.errors.push_back("could not open region file");
+        return result;
+    }
+    const regfile* file = rfile.get();
+    result.version = file->version;
+    result.usedBytes =
+        file->version >= 3 ? get_data_offset(file->version) : result.fileSize;
+
+    // (first sector, sectors count, chunk index)
+    std::vector<std::tuple<size_t, size_t, uint>> runs;
+    auto chunk = std::make_unique<Chunk>(0, 0);
+    for (uint i = 0; i < REGION_CHUNKS_COUNT; i++) {
+        auto error = [&result, i](const std::string& message) {
+            result.corrupted.set(i);
+            result.errors.push_back(
+                "chunk " + std::to_string(i) + ": " + message
+            );
+        };
+        regentry entry;
+        try {
+            entry = file->getEntry(i);
+        } catch (const std::exception& err) {
+            error(err.what());
+            continue;
+        }
+        if (entry.offset == 0) {
+            continue;
+        }
+        result.chunks++;
+        if (file->version >= 3) {
+            if (entry.offset % REGION_SECTOR_SIZE ||
+                entry.offset < get_data_offset(file->version)) {
+                error("invalid chunk data offset");
+                continue;
+            }
+            size_t sectors = count_sectors(entry.size);
+            result.usedBytes += sectors * REGION_SECTOR_SIZE;
+            runs.emplace_back(entry.offset / REGION_SECTOR_SIZE, sectors, i);
+        }
+        const ubyte* data = file->file.getData() + entry.offset;
+        if (file->version >= 4 &&
+            crc32(0L, data, entry.size) != entry.checksum) {
+            error("checksum mismatch");
+            continue;
+        }
+        try {
+            size_t length;
+            auto bytes =
+                decompress(data, entry.size, length, layer, file->compression);
+            if (!check_chunk_data(layer, bytes.get(), length, *chunk)) {
+                error("invalid chunk data");
+            }
+        } catch (const std::exception& err) {
+            error(err.what());
+        }
+    }
+    std::sort(runs.begin(), runs.end());
+    for (size_t i = 1; i < runs.size(); i++) {
+        const auto& [prevStart, prevCount, prevIndex] = runs[i - 1];
+        const auto& [start, count, index] = runs[i];
+        if (prevStart + prevCount > start) {
+            result.corrupted.set(prevIndex);
+            result.corrupted.set(index);
+            result.errors.push_back(
+                "chunk " + std::to_string(index) + ": data overlaps chunk " +
+                std::to_string(prevIndex)
+            );
+        }
+    }
+    return result;
+}
+
+size_t WorldRegions::compactRegion(
+    int x, int z, int layer, const regioncheck& check
+) {
+    flushRegion(x, z, layer);
+    WorldRegion region;
+    // chunks are kept compressed with the method of the file
+    compression::Method method;
+    {
+        auto regfile = getRegFile(glm::ivec3(x, z, layer));
+        if (regfile == nullptr) {
+            throw std::runtime_error("could not open region file");
+        }
+        method = regfile.get()->compression;
+        for (uint i = 0; i < REGION_CHUNKS_COUNT; i++) {
+            if (check.corrupted.test(i)) {
                 continue;
             }
-            data = decompress(data.get(), length, CHUNK_DATA_LEN);
-            if (func(data.get())) {
-                put(gx,
-                    gz,
-                    REGION_LAYER_VOXELS,
-                    std::move(data),
-                    CHUNK_DATA_LEN,
-                    true);
+            uint32_t length;
+            const ubyte* mapped = regfile.get()->read(i, length);
+            if (mapped == nullptr) {
+                continue;
             }
+            auto data = std::make_unique<ubyte[]>(length);
+            std::memcpy(data.get(), mapped, length);
+            region.put(
+                i % REGION_SIZE,
+                i / REGION_SIZE,
+                std::move(data),
+                length,
+                method
+            );
+        }
+    }
+    writeRegion(x, z, layer, &region, method, true);
+    return fs::file_size(layers[layer].folder / getRegionFilename(x, z));
+}
+
+void WorldRegions::prefetch(int x, int z) {
+    if (generatorTestMode) {
+        return;
+    }
+    glm::ivec2 key(x, z);
+    {
+        std::lock_guard lock(regFilesMutex);
+        glm::ivec3 coord(x, z, REGION_LAYER_VOXELS);
+        if (openRegFiles.find(coord) != openRegFiles.end() ||
+            !prefetchQueue.insert(key).second) {
+            return;
         }
     }
+    {
+        std::lock_guard lock(prefetchMutex);
+        prefetchTasks.push(key);
+    }
+    prefetchCv.notify_one();
 }
 
 fs::path WorldRegions::getRegionsFolder(int layer) const {
     return layers[layer].folder;
 }
 
-void WorldRegions::write() {
+size_t WorldRegions::getMappedBytes(int layer) const {
+    return layers[layer].mappedBytes;
+}
+
+/// @brief Shared state of regions written by single writeAsync call
+struct WriteBatch {
+    std::promise<void> promise;
+    std::exception_ptr error = nullptr;
+};
+
+void WorldRegions::queueWrite(
+    int layer,
+    glm::ivec2 key,
+    WorldRegion* region,
+    std::shared_ptr<WriteBatch> batch
+) {
+    // region files must not get ahead of the journal
+    queueJournal();
+
+    std::shared_ptr<WorldRegion> snapshot = region->clone();
+    region->setSaved();
+    region->pendingWrites++;
+    queuedWrites++;
+
+    pushTask([this, key, layer, snapshot, batch]() {
+        bool success = true;
+        try {
+            fs::create_directories(layers[layer].folder);
+            writeRegion(
+                key.x, key.y, layer, snapshot.get(), layers[layer].compression
+            );
+        } catch (const std::exception& err) {
+            logger.error() << "could not write region " << key.x << ", "
+                           << key.y << " (layer " << layer
+                           << "): " << err.what();
+            success = false;
+            if (batch && batch->error == nullptr) {
+                batch->error = std::current_exception();
+            }
+        }
+        finishWrite(key.x, key.y, layer, snapshot.get(), success);
+        finishedWrites++;
+    });
+}
+
+void WorldRegions::queueJournal() {
+    std::unordered_map<glm::ivec3, journalentry> entries;
+    {
+        std::lock_guard lock(journalMutex);
+        if (journalQueue.empty()) {
+            return;
+        }
+        std::swap(entries, journalQueue);
+    }
+    pushTask([this, entries = std::move(entries)]() {
+        try {
+            std::vector<std::unique_ptr<ubyte[]>> buffers;
+            std::vector<JournalRecord> records;
+            for (const auto& [key, entry] : entries) {
+                int layer = key.z;
+                if (layer == REGION_LAYER_ENTITIES) {
+                    size_t hash = std::hash<std::string_view>()(
+                        std::string_view(
+                            reinterpret_cast<const char*>(entry.data.get()),
+                            entry.size
+                        )
+                    );
+                    auto& prevHash = journaledEntities[key];
+                    if (hash == prevHash) {
+                        continue;
+                    }
+                    prevHash = hash;
+                }
+                auto method = layers[layer].compression;
+                size_t size;
+                buffers.push_back(
+                    compress(entry.data.get(), entry.size, size, layer)
+                );
+                records.push_back(
+                    {key.x,
+                     key.y,
+                     layer,
+                     method,
+                     buffers.back().get(),
+                     static_cast<uint32_t>(size)}
+                );
+            }
+            journal.append(records);
+        } catch (const std::exception& err) {
+            logger.error() << "could not write journal: " << err.what();
+        }
+    });
+}
+
+void WorldRegions::touchRegion(RegionsLayer& layer, WorldRegion* region) {
+    region->lastAccess = ++accessTicks;
+    layer.lru.splice(layer.lru.end(), layer.lru, region->lruPosition);
+}
+
+void WorldRegions::evictRegions() {
+    size_t writes = finishedWrites;
+    if (writes == stalledWrites) {
+        return;
+    }
+    // evicted below the budget, so it's not repeated on every put
+    size_t target = maxCachedBytes - maxCachedBytes / 4;
+
+    using lru_iterator = std::list<glm::ivec2>::iterator;
+    std::unique_lock<std::mutex> locks[REGION_LAYERS_COUNT];
+    lru_iterator cursors[REGION_LAYERS_COUNT];
+    for (size_t i = 0; i < REGION_LAYERS_COUNT; i++) {
+        locks[i] = std::unique_lock(layers[i].mutex);
+        cursors[i] = layers[i].lru.begin();
+    }
+    // size of unsaved regions going to be evicted after written
+    size_t flushedBytes = 0;
+    while (cachedBytes > target + flushedBytes) {
+        // least recently used region of all layers
+        int victim = -1;
+        WorldRegion* region = nullptr;
+        for (size_t i = 0; i < REGION_LAYERS_COUNT; i++) {
+            if (cursors[i] == layers[i].lru.end()) {
+                continue;
+            }
+            auto candidate = layers[i].regions.at(*cursors[i]).get();
+            if (region == nullptr ||
+                candidate->lastAccess < region->lastAccess) {
+                victim = i;
+                region = candidate;
+            }
+        }
+        if (region == nullptr) {
+            break;
+        }
+        auto& layer = layers[victim];
+        auto& cursor = cursors[victim];
+        if (region->pendingWrites) {
+            ++cursor;
+            continue;
+        }
+        if (region->isUnsaved()) {
+            flushedBytes += region->getDataSize();
+            queueWrite(victim, *cursor, region, nullptr);
+            ++cursor;
+            continue;
+        }
+        cachedBytes -= region->getDataSize();
+        layer.regions.erase(*cursor);
+        cursor = layer.lru.erase(cursor);
+        evictions++;
+    }
+    if (cachedBytes > target) {
+        // the rest is unsaved or being written
+        stalledWrites = writes;
+    }
+}
+
+std::shared_future<void> WorldRegions::writeAsync() {
+    auto batch = std::make_shared<WriteBatch>();
+    std::shared_future<void> future = batch->promise.get_future().share();
+    size_t failures = failedWrites;
     for (auto& layer : layers) {
         fs::create_directories(layer.folder);
-        writeRegions(layer.layer);
+
+        std::lock_guard lock(layer.mutex);
+        for (auto& [key, region] : layer.regions) {
+            if (region->isUnsaved()) {
+                queueWrite(layer.layer, key, region.get(), batch);
+            }
+        }
+    }
+    pushTask([this, batch, failures]() {
+        if (batch->error) {
+            batch->promise.set_exception(batch->error);
+            return;
+        }
+        // all journaled data is written to regions if no other write failed
+        if (failures == failedWrites) {
+            try {
+                journal.reset();
+                journaledEntities.clear();
+            } catch (const std::exception& err) {
+                logger.error() << "could not clear journal: " << err.what();
+            }
+        }
+        batch->promise.set_value();
+    });
+    return future;
+}
+
+void WorldRegions::write() {
+    writeAsync().get();
+}
+
+void WorldRegions::writeJournal() {
+    queueJournal();
+}
+
+void WorldRegions::replayJournal() {
+    if (generatorTestMode) {
+        return;
     }
+    size_t count = journal.replay([this](const JournalRecord& record) {
+        if (record.layer >= static_cast<int>(REGION_LAYERS_COUNT) ||
+            !compression::is_valid(static_cast<ubyte>(record.compression))) {
+            logger.error() << "invalid journal record of chunk " << record.x
+                           << ", " << record.z;
+            return;
+        }
+        try {
+            // decompressed to check the record is valid only
+            size_t length;
+            decompress(
+                record.data,
+                record.size,
+                length,
+                record.layer,
+                record.compression
+            );
+            // data is kept compressed with the journaled method and
+            // converted to the layer method when the region is written
+            auto data = std::make_unique<ubyte[]>(record.size);
+            std::memcpy(data.get(), record.data, record.size);
+            store(
+                record.x,
+                record.z,
+                record.layer,
+                std::move(data),
+                record.size,
+                record.compression
+            );
+        } catch (const std::exception& err) {
+            logger.error() << "could not read journal record of chunk "
+                           << record.x << ", " << record.z << ": "
+                           << err.what();
+        }
+    });
+    if (count) {
+        logger.info() << "replayed " << count << " journal records";
+    }
+}
+
+size_t WorldRegions::getJournalLength() const {
+    return journal.getLength();
+}
+
+size_t WorldRegions::getQueuedWrites() const {
+    return queuedWrites;
+}
+
+size_t WorldRegions::getFinishedWrites() const {
+    return finishedWrites;
+}
+
+size_t WorldRegions::getCachedBytes() const {
+    return cachedBytes;
+}
+
+size_t WorldRegions::getCacheHits() const {
+    return cacheHits;
+}
+
+size_t WorldRegions::getCacheMisses() const {
+    return cacheMisses;
+}
+
+size_t WorldRegions::getEvictions() const {
+    return evictions;
 }
 
 bool WorldRegions::parseRegionFilename(
@@ -1,18 +1,30 @@
 #ifndef FILES_WORLD_REGIONS_HPP_
 #define FILES_WORLD_REGIONS_HPP_
 
+#include <atomic>
+#include <bitset>
 #include <condition_variable>
+#include <cstdint>
 #include <filesystem>
 #include <functional>
+#include <future>
 #include <glm/glm.hpp>
+#include <list>
 #include <memory>
 #include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
+#include <coders/compression.hpp>
 #include <data/dynamic_fwd.hpp>
 #include <typedefs.hpp>
 #include <util/BufferPool.hpp>
 #include <voxels/Chunk.hpp>
+#include "RegionsJournal.hpp"
 #include "files.hpp"
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtx/hash.hpp"
@@ -25,12 +37,31 @@ inline constexpr uint REGION_LAYER_VOXELS = 0;
 inline constexpr uint REGION_LAYER_LIGHTS = 1;
 inline constexpr uint REGION_LAYER_INVENTORIES = 2;
 inline constexpr uint REGION_LAYER_ENTITIES = 3;
+inline constexpr uint REGION_LAYERS_COUNT = 4;
 
 inline constexpr uint REGION_SIZE_BIT = 5;
 inline constexpr uint REGION_SIZE = (1 << (REGION_SIZE_BIT));
 inline constexpr uint REGION_CHUNKS_COUNT = ((REGION_SIZE) * (REGION_SIZE));
-inline constexpr uint REGION_FORMAT_VERSION = 2;
-inline constexpr uint MAX_OPEN_REGION_FILES = 16;
+inline constexpr uint REGION_FORMAT_VERSION = 4;
+/// @brief Max number of region files kept open while not used.
+/// Files in use are never closed, so the limit may be exceeded
+inline constexpr uint MAX_OPEN_REGION_FILES = 64;
+/// @brief Journal length making it worth to be written to regions
+inline constexpr size_t REGIONS_JOURNAL_MAX_LENGTH = 64 * 1024 * 1024;
+
+/// @brief Size of region file allocation unit (format 3+)
+inline constexpr uint REGION_SECTOR_SIZE = 512;
+/// @brief Size of chunks table entry (format 4, format 3 entry has no
+/// checksum)
+inline constexpr uint REGION_ENTRY_SIZE = 12;
+/// @brief Offset of the first data sector (format 4)
+inline constexpr uint REGION_DATA_OFFSET =
+    (REGION_HEADER_SIZE + REGION_CHUNKS_COUNT * REGION_ENTRY_SIZE +
+     REGION_SECTOR_SIZE - 1) /
+    REGION_SECTOR_SIZE * REGION_SECTOR_SIZE;
+/// @brief Max uncompressed chunk data length accepted from the length
+/// prefix of layers with no maxDataLength (inventories, entities)
+inline constexpr size_t REGION_MAX_DATA_LENGTH = 64 * 1024 * 1024;
 
 class illegal_region_format : public std::runtime_error {
 public:
@@ -40,56 +71,185 @@ public:
 };
 
 class WorldRegion {
-    std::unique_ptr<std::unique_ptr<ubyte[]>[]> chunksData;
+    std::unique_ptr<std::shared_ptr<ubyte[]>[]> chunksData;
     std::unique_ptr<uint32_t[]> sizes;
-    bool unsaved = false;
+    std::unique_ptr<compression::Method[]> methods;
+    /// @brief Chunks data versions incremented by put only, so replaced
+    /// (e.g. recompressed) data keeps the version
+    std::unique_ptr<uint32_t[]> versions;
+    std::bitset<REGION_CHUNKS_COUNT> unsavedChunks;
+    size_t dataSize = 0;
 public:
+    /// @brief Number of queued writes of the region snapshots
+    uint pendingWrites = 0;
+    /// @brief Last access tick used to choose regions to evict
+    uint64_t lastAccess = 0;
+    /// @brief Position of the region in the layer LRU list
+    std::list<glm::ivec2>::iterator lruPosition;
+
     WorldRegion();
     ~WorldRegion();
 
-    void put(uint x, uint z, ubyte* data, uint32_t size);
-    ubyte* getChunkData(uint x, uint z);
-    uint getChunkDataSize(uint x, uint z);
+    /// @brief Put chunk data and mark it unsaved
+    /// @param method compression method used for the data
+    void put(
+        uint x,
+        uint z,
+        std::shared_ptr<ubyte[]> data,
+        uint32_t size,
+        compression::Method method
+    );
+    const std::shared_ptr<ubyte[]>& getChunkData(uint x, uint z) const;
+    uint getChunkDataSize(uint x, uint z) const;
+    compression::Method getChunkCompression(uint x, uint z) const;
+    uint32_t getChunkVersion(uint x, uint z) const;
+
+    /// @brief Replace chunk data keeping unsaved flag and version
+    /// @param index chunk index inside of the region
+    void replace(
+        size_t index,
+        std::shared_ptr<ubyte[]> data,
+        uint32_t size,
+        compression::Method method
+    );
 
-    void setUnsaved(bool unsaved);
+    /// @return total size of the chunks data stored in memory
+    size_t getDataSize() const;
+
+    /// @brief Mark all chunks saved
+    void setSaved();
     bool isUnsaved() const;
+    bool isChunkUnsaved(uint x, uint z) const;
+    void setChunkUnsaved(uint x, uint z);
+
+    /// @brief Create a copy sharing chunks data with the region
+    std::unique_ptr<WorldRegion> clone() const;
 
-    std::unique_ptr<ubyte[]>* getChunks() const;
+    std::shared_ptr<ubyte[]>* getChunks() const;
     uint32_t* getSizes() const;
+    compression::Method* getMethods() const;
 };
 
+/// @brief Chunks table entry
+struct regentry {
+    /// @brief Chunk data offset in the file (0 if chunk is not stored)
+    uint32_t offset;
+    /// @brief Chunk data size
+    uint32_t size;
+    /// @brief Chunk data crc32 (format 4+)
+    uint32_t checksum;
+};
+
+/// @brief Region file integrity check result
+struct regioncheck {
+    /// @brief Region file format version (0 if the header is corrupted)
+    int version = 0;
+    size_t fileSize = 0;
+    /// @brief Size of the header, chunks table and sectors occupied by the
+    /// chunks data (whole file for format 2)
+    size_t usedBytes = 0;
+    /// @brief Number of chunks stored in the file
+    uint chunks = 0;
+    /// @brief Chunks failed the check
+    std::bitset<REGION_CHUNKS_COUNT> corrupted;
+    /// @brief Found problems descriptions
+    std::vector<std::string> errors;
+
+    /// @return size of the space not occupied by the chunks data
+    size_t getUnusedBytes() const {
+        return fileSize > usedBytes ? fileSize - usedBytes : 0;
+    }
+};
+
+/// @brief Memory-mapped region file. Mapped data is read-only, so the
+/// file may be read by any number of threads at once
 struct regfile {
-    files::rafile file;
+    files::mmfile file;
     int version;
-    bool inUse = false;
-
-    regfile(fs::path filename);
+    /// @brief Chunks data compression method
+    compression::Method compression;
+    /// @brief Number of regfile_ptr using the file
+    uint users = 0;
+    /// @brief Last use tick used to choose files to close
+    uint64_t lastUse = 0;
+
+    /// @param filename region file path
+    /// @param defaultMethod compression method of files not specifying it
+    /// (written before compression methods introduced)
+    regfile(const fs::path& filename, compression::Method defaultMethod);
     regfile(const regfile&) = delete;
 
-    std::unique_ptr<ubyte[]> read(int index, uint32_t& length);
+    /// @brief Get chunks table entry
+    /// @param index chunk index inside of the region
+    /// @throws illegal_region_format if the entry is damaged
+    regentry getEntry(int index) const;
+
+    /// @brief Get chunks table entry as stored, without bounds checks
+    /// (format 3+)
+    /// @param index chunk index inside of the region
+    regentry readEntry(int index) const;
+
+    /// @brief Get chunk data without copying
+    /// @param index chunk index inside of the region
+    /// @param length (out argument) length of the chunk data
+    /// @return pointer to the mapped chunk data or nullptr if chunk is
+    /// not stored in the region file
+    const ubyte* read(int index, uint32_t& length) const;
 };
 
 using regionsmap = std::unordered_map<glm::ivec2, std::unique_ptr<WorldRegion>>;
-using regionproc = std::function<bool(ubyte*)>;
+/// @brief Chunk data processor. May replace the data and its size
+/// @return true if data is modified
+using regionproc = std::function<bool(std::unique_ptr<ubyte[]>&, size_t&)>;
 
 struct RegionsLayer {
     int layer;
     fs::path folder;
     regionsmap regions;
+    /// @brief Keys of the regions, least recently used first
+    std::list<glm::ivec2> lru;
     std::mutex mutex;
+    /// @brief Compression method used for the layer chunks
+    compression::Method compression;
+    /// @brief Compression method of the layer files not specifying it
+    compression::Method defaultCompression;
+    /// @brief Compression level (deflate only)
+    int compressionLevel = compression::DEFAULT_LEVEL;
+    /// @brief Max uncompressed chunk data length or 0 if not limited.
+    /// Compressed data of unlimited length is prefixed with the length
+    size_t maxDataLength = 0;
+    /// @brief Total size of currently mapped region files of the layer
+    std::atomic<size_t> mappedBytes = 0;
 };
 
 class regfile_ptr {
     regfile* file;
+    std::mutex* mutex;
     std::condition_variable* cv;
 public:
-    regfile_ptr(regfile* file, std::condition_variable* cv)
-        : file(file), cv(cv) {
+    regfile_ptr(regfile* file, std::mutex* mutex, std::condition_variable* cv)
+        : file(file), mutex(mutex), cv(cv) {
     }
 
     regfile_ptr(const regfile_ptr&) = delete;
 
-    regfile_ptr(std::nullptr_t) : file(nullptr), cv(nullptr) {
+    regfile_ptr(regfile_ptr&& other) noexcept
+        : file(other.file), mutex(other.mutex), cv(other.cv) {
+        other.file = nullptr;
+    }
+
+    regfile_ptr& operator=(regfile_ptr&& other) noexcept {
+        if (this != &other) {
+            reset();
+            file = other.file;
+            mutex = other.mutex;
+            cv = other.cv;
+            other.file = nullptr;
+        }
+        return *this;
+    }
+
+    regfile_ptr(std::nullptr_t) : file(nullptr), mutex(nullptr), cv(nullptr) {
     }
 
     bool operator==(std::nullptr_t) const {
@@ -109,103 +269,402 @@ public:
     }
     void reset() {
         if (file) {
-            file->inUse = false;
-            cv->notify_one();
+            {
+                std::lock_guard lock(*mutex);
+                file->users--;
+            }
+            cv->notify_all();
             file = nullptr;
         }
     }
 };
 
+/// @brief Chunk data stored in memory or in a mapped region file.
+/// Data buffer or region file is kept alive while the view is alive
+struct regdata {
+    const ubyte* data = nullptr;
+    uint32_t size = 0;
+    compression::Method compression = compression::Method::NONE;
+    std::shared_ptr<ubyte[]> buffer = nullptr;
+    regfile_ptr file = nullptr;
+
+    operator bool() const {
+        return data != nullptr;
+    }
+};
+
+/// @brief Chunk data put to regions but not written to the journal yet
+struct journalentry {
+    std::shared_ptr<ubyte[]> data;
+    uint32_t size;
+};
+
+struct WriteBatch;
+
 class WorldRegions {
     fs::path directory;
     std::unordered_map<glm::ivec3, std::unique_ptr<regfile>> openRegFiles;
+    /// @brief Region files being written, not available for reading
+    std::unordered_set<glm::ivec3> writtenRegFiles;
+    /// @brief Regions queued to be prefetched
+    std::unordered_set<glm::ivec2> prefetchQueue;
+    uint64_t regFilesTicks = 0;
     std::mutex regFilesMutex;
     std::condition_variable regFilesCv;
-    RegionsLayer layers[4] {};
+    RegionsLayer layers[REGION_LAYERS_COUNT] {};
     util::BufferPool<ubyte> bufferPool {
         std::max(CHUNK_DATA_LEN, LIGHTMAP_DATA_LEN) * 2};
 
+    /// @brief Background compression and region files writing tasks
+    std::queue<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksCv;
+    bool stopped = false;
+    std::atomic<size_t> queuedWrites = 0;
+    std::atomic<size_t> finishedWrites = 0;
+    std::thread writerThread;
+
+    /// @brief Regions to be prefetched. Read-ahead runs on its own
+    /// thread, so it neither waits behind the writes nor delays them
+    std::queue<glm::ivec2> prefetchTasks;
+    std::mutex prefetchMutex;
+    std::condition_variable prefetchCv;
+    bool prefetchStopped = false;
+    std::thread prefetchThread;
+
+    /// @brief Total size of the chunks data stored in memory
+    std::atomic<size_t> cachedBytes = 0;
+    std::atomic<uint64_t> accessTicks = 0;
+    std::atomic<size_t> cacheHits = 0;
+    std::atomic<size_t> cacheMisses = 0;
+    std::atomic<size_t> evictions = 0;
+    std::atomic<size_t> failedWrites = 0;
+    /// @brief Finished writes count when eviction could not get below
+    /// the budget. Eviction is skipped until another write is finished
+    size_t stalledWrites = SIZE_MAX;
+
+    RegionsJournal journal;
+    /// @brief Chunks data to be written to the journal
+    std::unordered_map<glm::ivec3, journalentry> journalQueue;
+    std::mutex journalMutex;
+    /// @brief Hashes of the entities data journaled last, so entities put
+    /// by every journal write are not journaled again if unchanged.
+    /// Used by the writer thread only
+    std::unordered_map<glm::ivec3, size_t> journaledEntities;
+
     WorldRegion* getRegion(int x, int z, int layer);
-    WorldRegion* getOrCreateRegion(int x, int z, int layer);
 
-    /// @brief Compress buffer with extrle
+    /// @brief Compress chunk data with the layer compression method
     /// @param src source buffer
     /// @param srclen length of the source buffer
     /// @param len (out argument) length of result buffer
+    /// @param layer regions layer
     /// @return compressed bytes array
     std::unique_ptr<ubyte[]> compress(
-        const ubyte* src, size_t srclen, size_t& len
+        const ubyte* src, size_t srclen, size_t& len, int layer
     );
 
-    /// @brief Decompress buffer with extrle
+    /// @brief Decompress chunk data
     /// @param src compressed buffer
     /// @param srclen length of compressed buffer
-    /// @param dstlen max expected length of source buffer
+    /// @param len (out argument) length of decompressed data
+    /// @param layer regions layer
+    /// @param method compression method used for the data
     /// @return decompressed bytes array
     std::unique_ptr<ubyte[]> decompress(
-        const ubyte* src, size_t srclen, size_t dstlen
+        const ubyte* src,
+        size_t srclen,
+        size_t& len,
+        int layer,
+        compression::Method method
+    );
+
+    /// @brief Compress data with the layer compression method
+    /// @param method compression method used for the data
+    std::unique_ptr<ubyte[]> recompress(
+        const ubyte* src,
+        size_t srclen,
+        size_t& len,
+        int layer,
+        compression::Method method
+    );
+
+    /// @brief Replace in-memory chunk data if it's not changed since
+    /// @param index chunk index inside of the region
+    /// @param expected chunk data to be replaced
+    void updateChunkData(
+        int x,
+        int z,
+        int layer,
+        size_t index,
+        const std::shared_ptr<ubyte[]>& expected,
+        std::shared_ptr<ubyte[]> data,
+        uint32_t size
+    );
+
+    /// @brief Capture region snapshot and queue writing it.
+    /// Layer mutex must be locked
+    /// @param batch writes batch or nullptr
+    void queueWrite(
+        int layer,
+        glm::ivec2 key,
+        WorldRegion* region,
+        std::shared_ptr<WriteBatch> batch
+    );
+
+    /// @brief Finish region write. Chunks are marked unsaved after failed
+    /// write if not put again since (see WorldRegion::getChunkVersion)
+    /// @param snapshot region data captured to be written
+    /// @param success write result
+    void finishWrite(
+        int x, int z, int layer, const WorldRegion* snapshot, bool success
     );
 
+    /// @brief Queue writing chunks data put since the last call to the
+    /// journal
+    void queueJournal();
+
+    /// @brief Write the in-memory region if unsaved and remove it from
+    /// memory, so the region file is the only copy of its data
+    /// @throws std::runtime_error if the region could not be written
+    void flushRegion(int x, int z, int layer);
+
+    /// @brief Mark the region used now. Layer mutex must be locked
+    void touchRegion(RegionsLayer& layer, WorldRegion* region);
+
+    /// @brief Free least recently used in-memory regions until cached
+    /// bytes are below 3/4 of the budget. Unsaved regions are written
+    /// first and evicted on the next calls
+    void evictRegions();
+
+    void pushTask(std::function<void()> task);
+    void runWriter();
+    void runPrefetcher();
+
     std::unique_ptr<ubyte[]> readChunkData(
         int x, int y, uint32_t& length, regfile* file
     );
 
-    void fetchChunks(WorldRegion* region, int x, int y, regfile* file);
+    /// @brief Read missing chunks data (null pointers) from region file.
+    /// Data is recompressed if the file compression method differs from
+    /// the layer one
+    /// @return number of chunks which could not be read
+    size_t fetchChunks(
+        WorldRegion* region, int x, int y, int layer, regfile* file
+    );
 
-    ubyte* getData(int x, int z, int layer, uint32_t& size);
+    /// @brief Get chunk data from memory or from the region file.
+    /// Data read from region file is not copied
+    regdata getData(int x, int z, int layer);
 
     regfile_ptr getRegFile(glm::ivec3 coord, bool create = true);
     void closeRegFile(glm::ivec3 coord);
-    regfile_ptr useRegFile(glm::ivec3 coord);
-    regfile_ptr createRegFile(glm::ivec3 coord);
+    void openRegFile(glm::ivec3 coord, const fs::path& file);
+    regfile_ptr useRegFile(regfile* file);
+    /// @brief Close least recently used files not in use until the open
+    /// files number fits MAX_OPEN_REGION_FILES
+    void closeUnusedRegFiles();
 
     fs::path getRegionFilename(int x, int y) const;
 
-    void writeRegions(int layer);
-
-    /// @brief Write or rewrite region file
+    /// @brief Write unsaved chunks of the region to the region file.
+    /// Files of older formats or compressed with other method are fully
+    /// rewritten. Called from the writer thread
     /// @param x region X
     /// @param z region Z
     /// @param layer regions layer
-    void writeRegion(int x, int y, int layer, WorldRegion* entry);
+    /// @param entry region snapshot
+    /// @param method compression method of the written file
+    /// @param compact write new file with all chunks of the snapshot
+    /// instead of updating existing one
+    void writeRegion(
+        int x,
+        int y,
+        int layer,
+        WorldRegion* entry,
+        compression::Method method,
+        bool compact = false
+    );
+
+    /// @brief Update the region file or write the new one aside and
+    /// replace the file with it
+    /// @param method compression method of the written file
+    /// @param compact write new file with all chunks of the snapshot
+    void writeRegionFile(
+        int x,
+        int y,
+        int layer,
+        WorldRegion* entry,
+        compression::Method method,
+        bool compact
+    );
+
+    /// @brief Read chunks table of the region file to update it in place.
+    /// Chunks of files in older formats or compressed with other method
+    /// are fetched to the region instead.
+    /// Files which could not be read completely are renamed to
+    /// damaged_<name> and kept for recovery
+    /// @return nullptr if the file should be rewritten completely
+    std::unique_ptr<regentry[]> readRegionTable(
+        int x,
+        int y,
+        int layer,
+        WorldRegion* entry,
+        compression::Method method,
+        const fs::path& filename
+    );
+
+    /// @brief Write unsaved chunks of the region to free or appended
+    /// sectors of the file, then write the chunks table
+    /// @param table chunks table of the existing file or nullptr to create
+    /// new file with all the region chunks
+    void writeRegionData(
+        int x,
+        int y,
+        int layer,
+        WorldRegion* entry,
+        compression::Method method,
+        const fs::path& filename,
+        regentry* table
+    );
+
+    /// @brief Store data in specified region without journaling
+    /// @param method compression method of the data. Data is compressed
+    /// in background with the layer method if not compressed
+    void store(
+        int x,
+        int z,
+        int layer,
+        std::shared_ptr<ubyte[]> data,
+        size_t size,
+        compression::Method method = compression::Method::NONE
+    );
 public:
     bool generatorTestMode = false;
     bool doWriteLights = true;
+    /// @brief Write chunks voxels in the palette format when it's smaller
+    bool paletteVoxels = true;
+    /// @brief Record chunks data put to regions to be written to the
+    /// journal (see writeJournal)
+    bool journaling = false;
+    /// @brief Max size of the chunks data kept in memory
+    size_t maxCachedBytes = 256 * 1024 * 1024;
 
     WorldRegions(const fs::path& directory);
     WorldRegions(const WorldRegions&) = delete;
     ~WorldRegions();
 
+    /// @brief Set compression method used to write the layer chunks
+    /// @param layer regions layer
+    /// @param method compression method
+    /// @param level compression level (deflate only)
+    void setCompression(
+        int layer,
+        compression::Method method,
+        int level = compression::DEFAULT_LEVEL
+    );
+
     /// @brief Put all chunk data to regions
     void put(Chunk* chunk, std::vector<ubyte> entitiesData);
 
-    /// @brief Store data in specified region
+    /// @brief Store data in specified region. Data is compressed in
+    /// background
     /// @param x chunk.x
     /// @param z chunk.z
     /// @param layer regions layer
     /// @param data target data
     /// @param size data size
-    /// @param rle compress with ext-RLE
     void put(
-        int x,
-        int z,
-        int layer,
-        std::unique_ptr<ubyte[]> data,
-        size_t size,
-        bool rle
+        int x, int z, int layer, std::unique_ptr<ubyte[]> data, size_t size
     );
 
-    std::unique_ptr<ubyte[]> getChunk(int x, int z);
+    /// @brief Get chunk voxels data
+    /// @param length decoded data length (see Chunk::decode)
+    /// @return voxels data or nullptr
+    std::unique_ptr<ubyte[]> getChunk(int x, int z, size_t& length);
     std::unique_ptr<light_t[]> getLights(int x, int z);
     chunk_inventories_map fetchInventories(int x, int z);
     dynamic::Map_sptr fetchEntities(int x, int z);
 
-    void processRegionVoxels(int x, int z, const regionproc& func);
+    /// @brief Process all chunks of the region file and write modified
+    /// ones right away, so only one region is kept in memory. The region
+    /// kept in memory is written and removed from memory first.
+    /// May be called for different regions from multiple threads
+    /// @param x region X
+    /// @param z region Z
+    /// @param layer regions layer
+    /// @param func chunk data processor
+    void processRegion(int x, int z, int layer, const regionproc& func);
+
+    /// @brief Open region files of all layers and read them into memory
+    /// in background, so chunks loading does not wait for disk reads.
+    /// Does nothing if region files are open already
+    /// @param x region X
+    /// @param z region Z
+    void prefetch(int x, int z);
+
+    /// @brief Check region file header, chunks table entries (offsets,
+    /// sizes, overlaps) and chunks data (checksums, decoding).
+    /// May be called for different regions from multiple threads
+    /// @param x region X
+    /// @param z region Z
+    /// @param layer regions layer
+    regioncheck checkRegion(int x, int z, int layer);
+
+    /// @brief Rewrite region file with chunks data placed contiguously,
+    /// dropping corrupted chunks. New file replaces the old one only
+    /// when written completely. The region kept in memory is written and
+    /// removed from memory first, so it must be saved before the check
+    /// @param x region X
+    /// @param z region Z
+    /// @param layer regions layer
+    /// @param check region check result (see checkRegion)
+    /// @return size of the new region file
+    size_t compactRegion(int x, int z, int layer, const regioncheck& check);
 
     fs::path getRegionsFolder(int layer) const;
 
+    /// @return total size of mapped region files of the layer
+    size_t getMappedBytes(int layer) const;
+
+    /// @brief Capture unsaved chunks and write them in background
+    /// @return future completed when all captured chunks are written
+    /// (holds exception if some regions could not be written)
+    std::shared_future<void> writeAsync();
+
+    /// @brief Write all unsaved chunks and wait until finished
     void write();
 
+    /// @brief Append chunks data put since the last call to the journal in
+    /// background. Much cheaper than writing regions, journal is written
+    /// to regions and cleared by writeAsync
+    void writeJournal();
+
+    /// @brief Put all chunks data stored in the journal (left after
+    /// unexpected exit) to regions. Must be called before chunks loading
+    void replayJournal();
+
+    /// @return journal file size
+    size_t getJournalLength() const;
+
+    /// @return number of region writes queued since creation
+    size_t getQueuedWrites() const;
+
+    /// @return number of region writes finished since creation
+    size_t getFinishedWrites() const;
+
+    /// @return total size of the chunks data kept in memory
+    size_t getCachedBytes() const;
+
+    /// @return number of chunk data requests served from memory
+    size_t getCacheHits() const;
+
+    /// @return number of chunk data requests not served from memory
+    size_t getCacheMisses() const;
+
+    /// @return number of regions evicted from memory
+    size_t getEvictions() const;
+
     /// @brief Extract X and Z from 'X_Z.bin' region file name.
     /// @param name source region file name
     /// @param x parsed X destination
@@ -14,6 +14,15 @@
 #include <data/dynamic.hpp>
 #include <util/stringutil.hpp>
 
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace fs = std::filesystem;
 
 files::rafile::rafile(const fs::path& filename)
@@ -37,6 +46,106 @@ void files::rafile::read(char* buffer, std::streamsize size) {
     file.read(buffer, size);
 }
 
+#ifdef _WIN32
+files::mmfile::mmfile(const fs::path& filename) {
+    HANDLE file = CreateFileW(
+        filename.c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        throw std::runtime_error("could not to open file " + filename.string());
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        throw std::runtime_error("could not to stat file " + filename.string());
+    }
+    filelength = static_cast<size_t>(size.QuadPart);
+    if (filelength == 0) {
+        CloseHandle(file);
+        return;
+    }
+    HANDLE mapping =
+        CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) {
+        throw std::runtime_error("could not to map file " + filename.string());
+    }
+    // the view keeps the mapping alive
+    data = static_cast<const ubyte*>(
+        MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)
+    );
+    CloseHandle(mapping);
+    if (data == nullptr) {
+        throw std::runtime_error("could not to map file " + filename.string());
+    }
+}
+
+files::mmfile::~mmfile() {
+    if (data) {
+        UnmapViewOfFile(data);
+    }
+}
+
+void files::mmfile::prefetch() const {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    volatile ubyte sink = 0;
+    for (size_t i = 0; i < filelength; i += info.dwPageSize) {
+        sink ^= data[i];
+    }
+}
+#else
+files::mmfile::mmfile(const fs::path& filename) {
+    int descriptor = open(filename.c_str(), O_RDONLY);
+    if (descriptor == -1) {
+        throw std::runtime_error("could not to open file " + filename.string());
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) == -1) {
+        close(descriptor);
+        throw std::runtime_error("could not to stat file " + filename.string());
+    }
+    filelength = static_cast<size_t>(info.st_size);
+    if (filelength == 0) {
+        close(descriptor);
+        return;
+    }
+    void* ptr = mmap(nullptr, filelength, PROT_READ, MAP_SHARED, descriptor, 0);
+    // the mapping stays valid after the descriptor is closed
+    close(descriptor);
+    if (ptr == MAP_FAILED) {
+        throw std::runtime_error("could not to map file " + filename.string());
+    }
+    data = static_cast<const ubyte*>(ptr);
+}
+
+files::mmfile::~mmfile() {
+    if (data) {
+        munmap(const_cast<ubyte*>(data), filelength);
+    }
+}
+
+void files::mmfile::prefetch() const {
+    if (data) {
+        madvise(const_cast<ubyte*>(data), filelength, MADV_WILLNEED);
+    }
+}
+#endif
+
+const ubyte* files::mmfile::getData() const {
+    return data;
+}
+
+size_t files::mmfile::length() const {
+    return filelength;
+}
+
 bool files::write_bytes(
     const fs::path& filename, const ubyte* data, size_t size
 ) {
@@ -58,6 +167,36 @@ uint files::append_bytes(
     return position;
 }
 
+#ifdef _WIN32
+bool files::sync(const fs::path& filename) {
+    HANDLE file = CreateFileW(
+        filename.c_str(),
+        GENERIC_WRITE,
+        FILE_SHARE_READ | FILE_SHARE_WRITE,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr
+    );
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool success = FlushFileBuffers(file);
+    CloseHandle(file);
+    return success;
+}
+#else
+bool files::sync(const fs::path& filename) {
+    int descriptor = open(filename.c_str(), O_WRONLY);
+    if (descriptor == -1) {
+        return false;
+    }
+    bool success = fsync(descriptor) == 0;
+    close(descriptor);
+    return success;
+}
+#endif
+
 bool files::read(const fs::path& filename, char* data, size_t size) {
     std::ifstream output(filename, std::ios::binary);
     if (!output.is_open()) return false;
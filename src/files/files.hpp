@@ -28,6 +28,26 @@ namespace files {
         size_t length() const;
     };
 
+    /// @brief Read-only memory-mapped file
+    class mmfile {
+        const ubyte* data = nullptr;
+        size_t filelength = 0;
+    public:
+        mmfile(const fs::path& filename);
+        mmfile(const mmfile&) = delete;
+        ~mmfile();
+
+        /// @return pointer to the mapped file content
+        /// (nullptr if the file is empty)
+        const ubyte* getData() const;
+        size_t length() const;
+
+        /// @brief Read the whole file into memory (page cache) ahead of
+        /// use. Blocks until read on platforms without asynchronous
+        /// read-ahead
+        void prefetch() const;
+    };
+
     /// @brief Write bytes array to the file without any extra data
     /// @param file target file
     /// @param data data bytes array
@@ -40,6 +60,11 @@ namespace files {
     /// @param size size of data bytes array
     uint append_bytes(const fs::path& file, const ubyte* data, size_t size);
 
+    /// @brief Flush file content cached by the OS to the storage device,
+    /// so it survives power loss and OS crash
+    /// @return false if the file could not be synchronized
+    bool sync(const fs::path& file);
+
     /// @brief Write string to the file
     bool write_string(const fs::path& filename, const std::string content);
 
@@ -69,6 +69,7 @@ SettingsHandler::SettingsHandler(EngineSettings& settings) {
     builder.add("backlight", &settings.graphics.backlight);
     builder.add("gamma", &settings.graphics.gamma);
     builder.add("frustum-culling", &settings.graphics.frustumCulling);
+    builder.add("greedy-meshing", &settings.graphics.greedyMeshing);
     builder.add("skybox-resolution", &settings.graphics.skyboxResolution);
 
     builder.section("ui");
@@ -78,6 +79,16 @@ SettingsHandler::SettingsHandler(EngineSettings& settings) {
     builder.section("debug");
     builder.add("generator-test-mode", &settings.debug.generatorTestMode);
     builder.add("do-write-lights", &settings.debug.doWriteLights);
+    builder.add("palette-voxels", &settings.debug.paletteVoxels);
+    builder.add("voxels-compression", &settings.debug.voxelsCompression);
+    builder.add("lights-compression", &settings.debug.lightsCompression);
+    builder.add(
+        "inventories-compression", &settings.debug.inventoriesCompression
+    );
+    builder.add("entities-compression", &settings.debug.entitiesCompression);
+    builder.add("compression-level", &settings.debug.compressionLevel);
+    builder.add("regions-cache-size", &settings.debug.regionsCacheSize);
+    builder.add("journal-interval", &settings.debug.journalInterval);
 }
 
 dynamic::Value SettingsHandler::getValue(const std::string& name) const {
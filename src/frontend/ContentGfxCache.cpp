@@ -7,6 +7,7 @@
 #include <content/ContentPack.hpp>
 #include <core_defs.hpp>
 #include <graphics/core/Atlas.hpp>
+#include <graphics/core/Texture.hpp>
 #include <maths/UVRegion.hpp>
 #include <voxels/Block.hpp>
 
@@ -16,6 +17,8 @@ ContentGfxCache::ContentGfxCache(const Content* content, Assets* assets) : conte
     auto indices = content->getIndices();
     sideregions = std::make_unique<UVRegion[]>(indices->blocks.count() * 6);
     auto atlas = assets->get<Atlas>("blocks");
+    auto texture = atlas->getTexture();
+    atlasSize = glm::uvec2(texture->getWidth(), texture->getHeight());
     
     const auto& blocks = indices->blocks.getIterable();
     for (uint i = 0; i < blocks.size(); i++) {
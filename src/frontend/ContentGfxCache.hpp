@@ -4,6 +4,7 @@
 #include <typedefs.hpp>
 
 #include <memory>
+#include <glm/glm.hpp>
 
 class Content;
 class Assets;
@@ -13,6 +14,8 @@ class ContentGfxCache {
     const Content* content;
     // array of block sides uv regions (6 per block)
     std::unique_ptr<UVRegion[]> sideregions;
+    // blocks atlas size in texels
+    glm::uvec2 atlasSize;
 public:
     ContentGfxCache(const Content* content, Assets* assets);
     ~ContentGfxCache();
@@ -20,6 +23,10 @@ public:
     inline const UVRegion& getRegion(blockid_t id, int side) const {
         return sideregions[id * 6 + side];
     }
+
+    inline const glm::uvec2& getAtlasSize() const {
+        return atlasSize;
+    }
     
     const Content* getContent() const;
 };
@@ -3,12 +3,14 @@
 #include <engine.hpp>
 #include <settings.hpp>
 #include <content/Content.hpp>
+#include <files/WorldFiles.hpp>
 #include <graphics/core/Mesh.hpp>
 #include <graphics/ui/elements/CheckBox.hpp>
 #include <graphics/ui/elements/TextBox.hpp>
 #include <graphics/ui/elements/TrackBar.hpp>
 #include <graphics/ui/elements/InputBindBox.hpp>
 #include <graphics/render/WorldRenderer.hpp>
+#include <graphics/render/ChunksRenderer.hpp>
 #include <logic/scripting/scripting.hpp>
 #include <objects/Player.hpp>
 #include <objects/Entities.hpp>
@@ -39,6 +41,7 @@ static std::shared_ptr<Label> create_label(wstringsupplier supplier) {
 std::shared_ptr<UINode> create_debug_panel(
     Engine* engine, 
     Level* level, 
+    WorldRenderer* worldRenderer,
     Player* player
 ) {
     auto panel = std::make_shared<Panel>(glm::vec2(300, 200), glm::vec4(5.0f), 2.0f);
@@ -87,6 +90,48 @@ std::shared_ptr<UINode> create_debug_panel(
         return L"chunks: "+std::to_wstring(level->chunks->chunksCount)+
                L" visible: "+std::to_wstring(level->chunks->visible);
     }));
+    panel->add(create_label([=]() {
+        const auto& stats = worldRenderer->getChunksRenderer()->getStats();
+        return L"chunks-meshing: "+std::to_wstring(stats.inwork)+
+               L" queued: "+std::to_wstring(stats.queued)+
+               L" latency: "+std::to_wstring(stats.latency / 1000)+L" ms"+
+               L" cancelled: "+std::to_wstring(stats.cancelled);
+    }));
+    panel->add(create_label([=]() {
+        auto& voxelsPool = ChunkVoxels::getPool();
+        auto& lightsPool = LightmapSections::getPool();
+        size_t used = voxelsPool.getUsed() * voxelsPool.getArrayBytes() +
+                      lightsPool.getUsed() * lightsPool.getArrayBytes();
+        size_t pooled = voxelsPool.getFree() * voxelsPool.getArrayBytes() +
+                        lightsPool.getFree() * lightsPool.getArrayBytes();
+        return L"chunks-sections: "+std::to_wstring(used / 1024)+L" KiB"+
+               L" pooled: "+std::to_wstring(pooled / 1024)+L" KiB"+
+               L" reused: "+std::to_wstring(
+                   voxelsPool.getReused() + lightsPool.getReused()
+               );
+    }));
+    panel->add(create_label([=]() {
+        auto& regions = level->getWorld()->wfile->getRegions();
+        size_t mapped = 0;
+        for (uint layer = 0; layer < REGION_LAYERS_COUNT; layer++) {
+            mapped += regions.getMappedBytes(layer);
+        }
+        return L"regions-mapped: "+std::to_wstring(mapped / 1024)+L" KiB";
+    }));
+    panel->add(create_label([=]() {
+        auto& regions = level->getWorld()->wfile->getRegions();
+        return L"regions-written: "+
+               std::to_wstring(regions.getFinishedWrites())+L"/"+
+               std::to_wstring(regions.getQueuedWrites());
+    }));
+    panel->add(create_label([=]() {
+        auto& regions = level->getWorld()->wfile->getRegions();
+        return L"regions-cache: "+
+               std::to_wstring(regions.getCachedBytes() / 1024)+L" KiB"+
+               L" hits: "+std::to_wstring(regions.getCacheHits())+
+               L" misses: "+std::to_wstring(regions.getCacheMisses())+
+               L" evicted: "+std::to_wstring(regions.getEvictions());
+    }));
     panel->add(create_label([=]() {
         return L"entities: "+std::to_wstring(level->entities->size())+L" next: "+
                std::to_wstring(level->entities->peekNextID());
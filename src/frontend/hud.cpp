@@ -56,6 +56,7 @@ using namespace gui;
 extern std::shared_ptr<UINode> create_debug_panel(
     Engine* engine, 
     Level* level, 
+    WorldRenderer* worldRenderer,
     Player* player
 );
 
@@ -140,7 +141,12 @@ std::shared_ptr<InventoryView> Hud::createHotbar() {
     return view;
 }
 
-Hud::Hud(Engine* engine, LevelFrontend* frontend, Player* player) 
+Hud::Hud(
+    Engine* engine,
+    LevelFrontend* frontend,
+    WorldRenderer* worldRenderer,
+    Player* player
+)
   : assets(engine->getAssets()), 
     gui(engine->getGUI()),
     frontend(frontend),
@@ -165,7 +171,9 @@ Hud::Hud(Engine* engine, LevelFrontend* frontend, Player* player)
     uicamera->perspective = false;
     uicamera->flipped = true;
 
-    debugPanel = create_debug_panel(engine, frontend->getLevel(), player);
+    debugPanel = create_debug_panel(
+        engine, frontend->getLevel(), worldRenderer, player
+    );
     debugPanel->setZIndex(2);
     
     gui->add(darkOverlay);
@@ -271,7 +279,7 @@ void Hud::update(bool visible) {
     }
 
     if (blockUI) {
-        voxel* vox = level->chunks->get(blockPos.x, blockPos.y, blockPos.z);
+        const voxel* vox = level->chunks->get(blockPos.x, blockPos.y, blockPos.z);
         if (vox == nullptr || vox->id != currentblockid) {
             closeInventory();
         }
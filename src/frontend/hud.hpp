@@ -16,6 +16,7 @@ class Player;
 class Engine;
 class Inventory;
 class LevelFrontend;
+class WorldRenderer;
 class UiDocument;
 class DrawContext;
 class Viewport;
@@ -119,7 +120,12 @@ class Hud : public util::ObjectsKeeper {
 
     void showExchangeSlot();
 public:
-    Hud(Engine* engine, LevelFrontend* frontend, Player* player);
+    Hud(
+        Engine* engine,
+        LevelFrontend* frontend,
+        WorldRenderer* worldRenderer,
+        Player* player
+    );
     ~Hud();
 
     void update(bool hudVisible);
@@ -41,11 +41,16 @@ LevelScreen::LevelScreen(Engine* engine, std::unique_ptr<Level> level)
     frontend = std::make_unique<LevelFrontend>(controller->getPlayer(), controller.get(), assets);
 
     worldRenderer = std::make_unique<WorldRenderer>(engine, frontend.get(), controller->getPlayer());
-    hud = std::make_unique<Hud>(engine, frontend.get(), controller->getPlayer());
+    hud = std::make_unique<Hud>(
+        engine, frontend.get(), worldRenderer.get(), controller->getPlayer()
+    );
     
     keepAlive(settings.graphics.backlight.observe([=](bool) {
         controller->getLevel()->chunks->saveAndClear();
     }));
+    keepAlive(settings.graphics.greedyMeshing.observe([=](bool) {
+        controller->getLevel()->chunks->saveAndClear();
+    }));
     keepAlive(settings.camera.fov.observe([=](double value) {
         controller->getPlayer()->camera->setFov(glm::radians(value));
     }));
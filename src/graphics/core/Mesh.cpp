@@ -24,7 +24,13 @@ Mesh::Mesh(const float* vertexBuffer, size_t vertices, const int* indexBuffer, s
     int offset = 0;
     for (int i = 0; attrs[i].size; i++) {
         int size = attrs[i].size;
-        glVertexAttribPointer(i, size, GL_FLOAT, GL_FALSE, vertexSize * sizeof(float), (GLvoid*)(offset * sizeof(float)));
+        GLsizei stride = vertexSize * sizeof(float);
+        GLvoid* pointer = (GLvoid*)(offset * sizeof(float));
+        if (attrs[i].integer) {
+            glVertexAttribIPointer(i, size, GL_UNSIGNED_INT, stride, pointer);
+        } else {
+            glVertexAttribPointer(i, size, GL_FLOAT, GL_FALSE, stride, pointer);
+        }
         glEnableVertexAttribArray(i);
         offset += size;
     }
@@ -6,6 +6,9 @@
 
 struct vattr {
     ubyte size;
+    /// @brief Attribute values are unsigned integers (not converted to
+    /// float), each takes 4 bytes as float does
+    bool integer = false;
 };
 
 class Mesh {
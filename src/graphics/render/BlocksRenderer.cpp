@@ -1,4 +1,5 @@
 #include "BlocksRenderer.hpp"
+#include "ChunkVertex.hpp"
 
 #include <graphics/core/Mesh.hpp>
 #include <maths/UVRegion.hpp>
@@ -7,27 +8,76 @@
 #include <voxels/Block.hpp>
 #include <voxels/Chunk.hpp>
 #include <voxels/VoxelsVolume.hpp>
-#include <voxels/ChunksStorage.hpp>
-#include <lighting/Lightmap.hpp>
+#include <voxels/ChunksSnapshot.hpp>
 #include <frontend/ContentGfxCache.hpp>
 #include <settings.hpp>
 
+#include <algorithm>
 #include <glm/glm.hpp>
 
 using glm::ivec3;
+using glm::uvec4;
 using glm::vec3;
 using glm::vec4;
 
-const uint BlocksRenderer::VERTEX_SIZE = 6;
+const uint BlocksRenderer::VERTEX_SIZE = ChunkVertex::SIZE;
 const vec3 BlocksRenderer::SUN_VECTOR (0.411934f, 0.863868f, -0.279161f);
 
+/// @brief Spread light_t channels 4 bit values to bytes (channel 0 in
+/// the low byte). Sum of up to 17 spread lights has no carries between
+/// the bytes, so all channels are summed with a single integer add
+static inline uint32_t spread_light(light_t light) {
+    uint32_t spread = light;
+    spread = (spread | spread << 8) & 0x00FF00FF;
+    return (spread | spread << 4) & 0x0F0F0F0F;
+}
+
+/// @param scale factor applied to channels values
+static inline vec4 unpack_spread_light(uint32_t light, float scale) {
+    return vec4(
+        light & 0xFF, (light >> 8) & 0xFF, (light >> 16) & 0xFF, light >> 24
+    ) * scale;
+}
+
+/// @brief Pack light to RGBA8 bits
+static inline uint32_t compress_light(const vec4& light) {
+    uint32_t compressed = (static_cast<uint32_t>(light.r * 255) & 0xff) << 24;
+    compressed |= (static_cast<uint32_t>(light.g * 255) & 0xff) << 16;
+    compressed |= (static_cast<uint32_t>(light.b * 255) & 0xff) << 8;
+    compressed |= (static_cast<uint32_t>(light.a * 255) & 0xff);
+    return compressed;
+}
+
+/// @brief Get atlas region in texels as encoded on tiled faces
+/// @return zero if the region does not fit the ChunkVertex limits
+static uvec4 get_tiled_region(
+    const UVRegion& region, const glm::uvec2& atlasSize
+) {
+    if (atlasSize.x > ChunkVertex::MAX_ATLAS_SIZE ||
+        atlasSize.y > ChunkVertex::MAX_ATLAS_SIZE) {
+        return {};
+    }
+    glm::ivec2 size(atlasSize);
+    glm::vec2 scale(size);
+    glm::ivec2 start(glm::round(glm::vec2(region.u1, region.v1) * scale));
+    glm::ivec2 end(glm::round(glm::vec2(region.u2, region.v2) * scale));
+    glm::ivec2 extent = end - start;
+    int maxSize = ChunkVertex::MAX_REGION_SIZE;
+    if (start.x < 0 || start.y < 0 || end.x > size.x || end.y > size.y ||
+        extent.x <= 0 || extent.y <= 0 ||
+        extent.x > maxSize || extent.y > maxSize) {
+        return {};
+    }
+    return uvec4(start.x, start.y, extent.x, extent.y);
+}
+
 BlocksRenderer::BlocksRenderer(
     size_t capacity,
     const Content* content,
     const ContentGfxCache* cache,
     const EngineSettings* settings
 ) : content(content),
-    vertexBuffer(std::make_unique<float[]>(capacity)),
+    vertexBuffer(std::make_unique<uint32_t[]>(capacity)),
     indexBuffer(std::make_unique<int[]>(capacity)),
     vertexOffset(0),
     indexOffset(0),
@@ -41,6 +91,41 @@ BlocksRenderer::BlocksRenderer(
         CHUNK_H, 
         CHUNK_D + voxelBufferPadding*2);
     blockDefsCache = content->getIndices()->blocks.getDefs();
+    const auto& defs = content->getIndices()->blocks.getIterable();
+    for (const auto def : defs) {
+        lightPassing.push_back(def->lightPassing);
+    }
+    static_assert(CHUNK_W + 4 <= 32, "voxels buffer row must fit a mask");
+    for (const auto group : *content->drawGroups) {
+        auto& table = openTables[group];
+        for (const auto def : defs) {
+            table.push_back(
+                def->rt.id == 0 || !def->rt.solid ||
+                (def->lightPassing && def->drawGroup != group)
+            );
+        }
+        // BLOCK_VOID
+        table.push_back(0);
+    }
+    openMasks = std::make_unique<uint32_t[]>(
+        (CHUNK_H + 2) * voxelsBuffer->getD()
+    );
+    for (const auto def : defs) {
+        lightOpenTable.push_back(def->rt.id == 0 || def->lightPassing);
+    }
+    // BLOCK_VOID
+    lightOpenTable.push_back(0);
+    const glm::uvec2& atlasSize = cache->getAtlasSize();
+    for (const auto def : defs) {
+        for (int side = 0; side < 6; side++) {
+            tiledRegions.push_back(
+                get_tiled_region(cache->getRegion(def->rt.id, side), atlasSize)
+            );
+        }
+    }
+    lightsBuffer = std::make_unique<uint32_t[]>(
+        voxelsBuffer->getW() * voxelsBuffer->getH() * voxelsBuffer->getD()
+    );
 }
 
 BlocksRenderer::~BlocksRenderer() {
@@ -48,24 +133,18 @@ BlocksRenderer::~BlocksRenderer() {
 
 /* Basic vertex add method */
 void BlocksRenderer::vertex(const vec3& coord, float u, float v, const vec4& light) {
-    vertexBuffer[vertexOffset++] = coord.x;
-    vertexBuffer[vertexOffset++] = coord.y;
-    vertexBuffer[vertexOffset++] = coord.z;
-
-    vertexBuffer[vertexOffset++] = u;
-    vertexBuffer[vertexOffset++] = v;
-
-    union {
-        float floating;
-        uint32_t integer;
-    } compressed;
-
-    compressed.integer = (static_cast<uint32_t>(light.r * 255) & 0xff) << 24;
-    compressed.integer |= (static_cast<uint32_t>(light.g * 255) & 0xff) << 16;
-    compressed.integer |= (static_cast<uint32_t>(light.b * 255) & 0xff) << 8;
-    compressed.integer |= (static_cast<uint32_t>(light.a * 255) & 0xff);
+    ChunkVertex vertex {
+        coord - sectionOrigin, {u, v}, {}, compress_light(light)};
+    vertex.pack(vertexBuffer.get() + vertexOffset);
+    vertexOffset += VERTEX_SIZE;
+}
 
-    vertexBuffer[vertexOffset++] = compressed.floating;
+void BlocksRenderer::vertexTiled(
+    const vec3& coord, float u, float v, uint32_t light, const uvec4& region
+) {
+    ChunkVertex vertex {coord - sectionOrigin, {u, v}, region, light};
+    vertex.pack(vertexBuffer.get() + vertexOffset);
+    vertexOffset += VERTEX_SIZE;
 }
 
 void BlocksRenderer::index(int a, int b, int c, int d, int e, int f) {
@@ -348,6 +427,183 @@ void BlocksRenderer::blockCustomModel(
     }
 }
 
+void BlocksRenderer::greedyFace(
+    const vec3& coord,
+    const ivec3& X,
+    const ivec3& Y,
+    const ivec3& Z,
+    int w, int h,
+    const UVRegion& region,
+    const uvec4& tiled,
+    const uint32_t(&lights)[4]
+) {
+    if (vertexOffset + BlocksRenderer::VERTEX_SIZE * 4 > capacity) {
+        overflow = true;
+        return;
+    }
+    vec3 base = coord + vec3(-X - Y + Z) * 0.5f;
+    vec3 dx = vec3(X * w);
+    vec3 dy = vec3(Y * h);
+    if (tiled.z == 0) {
+        vertexTiled(base, region.u1, region.v1, lights[0], tiled);
+        vertexTiled(base + dx, region.u2, region.v1, lights[1], tiled);
+        vertexTiled(base + dx + dy, region.u2, region.v2, lights[2], tiled);
+        vertexTiled(base + dy, region.u1, region.v2, lights[3], tiled);
+    } else {
+        vertexTiled(base, 0, 0, lights[0], tiled);
+        vertexTiled(base + dx, w, 0, lights[1], tiled);
+        vertexTiled(base + dx + dy, w, h, lights[2], tiled);
+        vertexTiled(base + dy, 0, h, lights[3], tiled);
+    }
+    index(0, 1, 2, 0, 2, 3);
+}
+
+/// @brief Cube face axes (as used in blockCube) and texture face index
+struct CubeFaceDir {
+    ivec3 X, Y, Z;
+    int texface;
+};
+
+static const CubeFaceDir CUBE_FACES[6] {
+    {{1, 0, 0}, {0, 1, 0}, {0, 0, 1}, 5}, // north
+    {{-1, 0, 0}, {0, 1, 0}, {0, 0, -1}, 4}, // south
+    {{1, 0, 0}, {0, 0, -1}, {0, 1, 0}, 3}, // top
+    {{1, 0, 0}, {0, 0, 1}, {0, -1, 0}, 2}, // bottom
+    {{0, 0, -1}, {0, 1, 0}, {1, 0, 0}, 1}, // west
+    {{0, 0, 1}, {0, 1, 0}, {-1, 0, 0}, 0}, // east
+};
+
+/// @brief Cube face of the greedy meshing mask
+struct GreedyFace {
+    /// @brief Face texture region or nullptr if there is no face
+    const UVRegion* region = nullptr;
+    /// @brief Face texture region in texels, zero if not repeatable
+    const uvec4* tiled = nullptr;
+    /// @brief Compressed lights of the face corners
+    uint32_t lights[4];
+
+    bool canMerge(const GreedyFace& other) const {
+        return other.region && tiled->z != 0 && *tiled == *other.tiled &&
+               std::equal(lights, lights + 4, other.lights);
+    }
+};
+
+/// @return true if block faces are built by greedyCubes
+static inline bool is_greedy_cube(const Block& def, blockstate state) {
+    return def.model == BlockModel::block && !def.rotatable &&
+           !state.segment;
+}
+
+void BlocksRenderer::greedyCubes(
+    const ChunkVoxels& voxels, int section, ubyte drawGroup
+) {
+    constexpr int MASK_SIZE =
+        std::max(std::max(CHUNK_W, CHUNK_D), CHUNK_SECTION_H);
+    static_assert(
+        MASK_SIZE <= ChunkVertex::MAX_TILES, "tiled face is too large"
+    );
+    GreedyFace mask[MASK_SIZE * MASK_SIZE];
+
+    ivec3 lo(0, std::max(chunk->bottom, section * CHUNK_SECTION_H), 0);
+    ivec3 hi(
+        CHUNK_W,
+        std::min(chunk->top, (section + 1) * CHUNK_SECTION_H),
+        CHUNK_D
+    );
+    if (lo.y >= hi.y) {
+        return;
+    }
+    ivec3 size = hi - lo;
+    for (const auto& dir : CUBE_FACES) {
+        const ivec3& X = dir.X;
+        const ivec3& Y = dir.Y;
+        const ivec3& Z = dir.Z;
+        // slice cells are start + X * u + Y * v
+        ivec3 start = lo;
+        for (int c = 0; c < 3; c++) {
+            if (X[c] < 0 || Y[c] < 0) {
+                start[c] = hi[c] - 1;
+            }
+        }
+        int w = glm::dot(glm::abs(X), size);
+        int h = glm::dot(glm::abs(Y), size);
+        int depth = glm::dot(glm::abs(Z), size);
+        float d = 0.8f + glm::dot(vec3(Z), SUN_VECTOR) * 0.2f;
+
+        for (int k = 0; k < depth; k++, start += glm::abs(Z)) {
+            for (int v = 0; v < h; v++) {
+                for (int u = 0; u < w; u++) {
+                    ivec3 pos = start + X * u + Y * v;
+                    GreedyFace& face = mask[v * w + u];
+                    face.region = nullptr;
+
+                    const voxel& vox = voxels[vox_index(pos.x, pos.y, pos.z)];
+                    const Block& def = *blockDefsCache[vox.id];
+                    if (vox.id == 0 || def.drawGroup != drawGroup ||
+                        !is_greedy_cube(def, vox.state) ||
+                        !isOpen(pos.x + Z.x, pos.y + Z.y, pos.z + Z.z)) {
+                        continue;
+                    }
+                    face.region = &cache->getRegion(vox.id, dir.texface);
+                    face.tiled = &tiledRegions[vox.id * 6 + dir.texface];
+                    // same lights as faceAO and face calculate
+                    if (def.ambientOcclusion && !def.shadeless) {
+                        const ivec3 corners[4] {{}, X, X + Y, Y};
+                        for (int c = 0; c < 4; c++) {
+                            ivec3 coord = pos + Z + corners[c];
+                            face.lights[c] = compress_light(
+                                pickSoftLight(coord, X, Y) * d
+                            );
+                        }
+                        continue;
+                    }
+                    vec4 light(1.0f);
+                    if (!def.ambientOcclusion) {
+                        light = pickLight(pos + Z);
+                        if (!def.shadeless) {
+                            light *= d;
+                        }
+                    }
+                    std::fill_n(face.lights, 4, compress_light(light));
+                }
+            }
+            for (int v = 0; v < h; v++) {
+                for (int u = 0; u < w; u++) {
+                    GreedyFace& face = mask[v * w + u];
+                    if (face.region == nullptr) {
+                        continue;
+                    }
+                    int fw = 1;
+                    while (u + fw < w && face.canMerge(mask[v * w + u + fw])) {
+                        fw++;
+                    }
+                    int fh = 1;
+                    for (; v + fh < h; fh++) {
+                        const GreedyFace* row = &mask[(v + fh) * w + u];
+                        if (!std::all_of(row, row + fw, [&](const auto& f) {
+                                return face.canMerge(f);
+                            })) {
+                            break;
+                        }
+                    }
+                    greedyFace(
+                        vec3(start + X * u + Y * v), X, Y, Z, fw, fh,
+                        *face.region, *face.tiled, face.lights
+                    );
+                    if (overflow) {
+                        return;
+                    }
+                    for (int j = 0; j < fh; j++) {
+                        for (int i = 0; i < fw; i++) {
+                            mask[(v + j) * w + u + i].region = nullptr;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
 /* Fastest solid shaded blocks render method */
 void BlocksRenderer::blockCube(
     int x, int y, int z, 
@@ -357,8 +613,6 @@ void BlocksRenderer::blockCube(
     bool lights,
     bool ao
 ) {
-    ubyte group = block->drawGroup;
-
     vec3 X(1, 0, 0);
     vec3 Y(0, 1, 0);
     vec3 Z(0, 0, 1);
@@ -372,86 +626,124 @@ void BlocksRenderer::blockCube(
     }
     
     if (ao) {
-        if (isOpen(x+Z.x, y+Z.y, z+Z.z, group)) {
+        if (isOpen(x+Z.x, y+Z.y, z+Z.z)) {
             faceAO(coord, X, Y, Z, texfaces[5], lights);
         }
-        if (isOpen(x-Z.x, y-Z.y, z-Z.z, group)) {
+        if (isOpen(x-Z.x, y-Z.y, z-Z.z)) {
             faceAO(coord, -X, Y, -Z, texfaces[4], lights);
         }
-        if (isOpen(x+Y.x, y+Y.y, z+Y.z, group)) {
+        if (isOpen(x+Y.x, y+Y.y, z+Y.z)) {
             faceAO(coord, X, -Z, Y, texfaces[3], lights);
         }
-        if (isOpen(x-Y.x, y-Y.y, z-Y.z, group)) {
+        if (isOpen(x-Y.x, y-Y.y, z-Y.z)) {
             faceAO(coord, X, Z, -Y, texfaces[2], lights);
         }
-        if (isOpen(x+X.x, y+X.y, z+X.z, group)) {
+        if (isOpen(x+X.x, y+X.y, z+X.z)) {
             faceAO(coord, -Z, Y, X, texfaces[1], lights);
         }
-        if (isOpen(x-X.x, y-X.y, z-X.z, group)) {
+        if (isOpen(x-X.x, y-X.y, z-X.z)) {
             faceAO(coord, Z, Y, -X, texfaces[0], lights);
         }
     } else {
-        if (isOpen(x+Z.x, y+Z.y, z+Z.z, group)) {
+        if (isOpen(x+Z.x, y+Z.y, z+Z.z)) {
             face(coord, X, Y, Z, texfaces[5], pickLight({x, y, z+1}), lights);
         }
-        if (isOpen(x-Z.x, y-Z.y, z-Z.z, group)) {
+        if (isOpen(x-Z.x, y-Z.y, z-Z.z)) {
             face(coord, -X, Y, -Z, texfaces[4], pickLight({x, y, z-1}), lights);
         }
-        if (isOpen(x+Y.x, y+Y.y, z+Y.z, group)) {
+        if (isOpen(x+Y.x, y+Y.y, z+Y.z)) {
             face(coord, X, -Z, Y, texfaces[3], pickLight({x, y+1, z}), lights);
         }
-        if (isOpen(x-Y.x, y-Y.y, z-Y.z, group)) {
+        if (isOpen(x-Y.x, y-Y.y, z-Y.z)) {
             face(coord, X, Z, -Y, texfaces[2], pickLight({x, y-1, z}), lights);
         }
-        if (isOpen(x+X.x, y+X.y, z+X.z, group)) {
+        if (isOpen(x+X.x, y+X.y, z+X.z)) {
             face(coord, -Z, Y, X, texfaces[1], pickLight({x+1, y, z}), lights);
         }
-        if (isOpen(x-X.x, y-X.y, z-X.z, group)) {
+        if (isOpen(x-X.x, y-X.y, z-X.z)) {
             face(coord, Z, Y, -X, texfaces[0], pickLight({x-1, y, z}), lights);
         }
     }
 }
 
-// Does block allow to see other blocks sides (is it transparent)
-bool BlocksRenderer::isOpen(int x, int y, int z, ubyte group) const {
-    blockid_t id = voxelsBuffer->pickBlockId(chunk->x * CHUNK_W + x, 
-                                             y, 
-                                             chunk->z * CHUNK_D + z);
-    if (id == BLOCK_VOID) {
-        return false;
+void BlocksRenderer::buildOpenMasks(ubyte group, int yBegin, int yEnd) {
+    const auto& table = openTables[group];
+    const size_t maxId = table.size() - 1;
+    const voxel* voxels = voxelsBuffer->getVoxels();
+    const int w = voxelsBuffer->getW();
+    const int d = voxelsBuffer->getD();
+    yBegin = std::max(yBegin - 1, 0);
+    yEnd = std::min(yEnd + 1, CHUNK_H);
+    for (int y = yBegin; y < yEnd; y++) {
+        for (int z = 0; z < d; z++) {
+            const voxel* row = voxels + vox_index(0, y, z, w, d);
+            uint32_t mask = 0;
+            for (int x = 0; x < w; x++) {
+                size_t id = std::min<size_t>(row[x].id, maxId);
+                mask |= static_cast<uint32_t>(table[id]) << x;
+            }
+            openMasks[(y + 1) * d + z] = mask;
+        }
     }
-    const Block& block = *blockDefsCache[id];
-    if ((block.drawGroup != group && block.lightPassing) || !block.rt.solid) {
-        return true;
+}
+
+// Does block allow to see other blocks sides (is it transparent)
+bool BlocksRenderer::isOpen(int x, int y, int z) const {
+    int row = (y + 1) * voxelsBuffer->getD() + z + voxelBufferPadding;
+    return openMasks[row] >> (x + voxelBufferPadding) & 1;
+}
+
+uint32_t BlocksRenderer::getExposedCells(int y, int z) const {
+    const int d = voxelsBuffer->getD();
+    const uint32_t* row =
+        openMasks.get() + (y + 1) * d + z + voxelBufferPadding;
+    // neighbours by x are the same row shifted
+    uint32_t exposed = row[0] << 1 | row[0] >> 1 | row[-1] | row[1] |
+                       row[-d] | row[d];
+    return exposed >> voxelBufferPadding;
+}
+
+void BlocksRenderer::buildLights(int yBegin, int yEnd) {
+    const size_t maxId = lightOpenTable.size() - 1;
+    const voxel* voxels = voxelsBuffer->getVoxels();
+    const light_t* lights = voxelsBuffer->getLights();
+    const int w = voxelsBuffer->getW();
+    const int d = voxelsBuffer->getD();
+    lightsBegin = std::max(yBegin - 1, 0);
+    lightsEnd = std::min(yEnd + 1, CHUNK_H);
+    size_t begin = vox_index(0, lightsBegin, 0, w, d);
+    size_t end = vox_index(0, lightsEnd, 0, w, d);
+    for (size_t i = begin; i < end; i++) {
+        size_t id = std::min<size_t>(voxels[i].id, maxId);
+        // multiplied instead of branching on the flag
+        lightsBuffer[i] = spread_light(lights[i]) * lightOpenTable[id];
     }
-    return !id;
 }
 
-bool BlocksRenderer::isOpenForLight(int x, int y, int z) const {
-    blockid_t id = voxelsBuffer->pickBlockId(chunk->x * CHUNK_W + x, 
-                                             y, 
-                                             chunk->z * CHUNK_D + z);
-    if (id == BLOCK_VOID) {
-        return false;
+uint32_t BlocksRenderer::pickSpreadLight(int x, int y, int z) const {
+    const int w = voxelsBuffer->getW();
+    const int d = voxelsBuffer->getD();
+    x += voxelBufferPadding;
+    z += voxelBufferPadding;
+    if (x < 0 || y < 0 || z < 0 || x >= w || y >= CHUNK_H || z >= d) {
+        return 0;
     }
-    const Block& block = *blockDefsCache[id];
-    if (block.lightPassing) {
-        return true;
+    size_t index = vox_index(x, y, z, w, d);
+    if (y >= lightsBegin && y < lightsEnd) {
+        return lightsBuffer[index];
     }
-    return !id;
+    // out of the rows built (e.g. by a custom model)
+    size_t id = std::min<size_t>(
+        voxelsBuffer->getVoxels()[index].id, lightOpenTable.size() - 1
+    );
+    if (lightOpenTable[id]) {
+        return spread_light(voxelsBuffer->getLights()[index]);
+    }
+    return 0;
 }
 
 vec4 BlocksRenderer::pickLight(int x, int y, int z) const {
-    if (isOpenForLight(x, y, z)) {
-        light_t light = voxelsBuffer->pickLight(chunk->x * CHUNK_W + x, y, 
-                                                chunk->z * CHUNK_D + z);
-        return vec4(Lightmap::extract(light, 0) / 15.0f,
-                    Lightmap::extract(light, 1) / 15.0f,
-                    Lightmap::extract(light, 2) / 15.0f,
-                    Lightmap::extract(light, 3) / 15.0f);
-    } else {
-        return vec4(0.0f);
-    }
+    return unpack_spread_light(pickSpreadLight(x, y, z), 1.0f / 15.0f);
 }
 
 vec4 BlocksRenderer::pickLight(const ivec3& coord) const {
@@ -461,10 +753,15 @@ vec4 BlocksRenderer::pickLight(const ivec3& coord) const {
 vec4 BlocksRenderer::pickSoftLight(const ivec3& coord, 
                                    const ivec3& right, 
                                    const ivec3& up) const {
-    return (pickLight(coord) +
-            pickLight(coord - right) +
-            pickLight(coord - right - up) +
-            pickLight(coord - up)) * 0.25f;
+    ivec3 side = coord - right;
+    ivec3 corner = side - up;
+    ivec3 below = coord - up;
+    // channels of the 4 samples are summed at once (see spread_light)
+    uint32_t sum = pickSpreadLight(coord.x, coord.y, coord.z) +
+                   pickSpreadLight(side.x, side.y, side.z) +
+                   pickSpreadLight(corner.x, corner.y, corner.z) +
+                   pickSpreadLight(below.x, below.y, below.z);
+    return unpack_spread_light(sum, 1.0f / 60.0f);
 }
 
 vec4 BlocksRenderer::pickSoftLight(float x, float y, float z, 
@@ -477,10 +774,31 @@ vec4 BlocksRenderer::pickSoftLight(float x, float y, float z,
         right, up);
 }
 
-void BlocksRenderer::render(const voxel* voxels) {
-    int begin = chunk->bottom * (CHUNK_W * CHUNK_D);
-    int end = chunk->top * (CHUNK_W * CHUNK_D);
+void BlocksRenderer::render(const ChunkVoxels& voxels, int section) {
+    if (voxels.getSection(section) == nullptr &&
+        voxels.getFill(section).id == BLOCK_AIR) {
+        // empty section
+        return;
+    }
+    int begin = std::max(chunk->bottom, section * CHUNK_SECTION_H);
+    int end = std::min(chunk->top, (section + 1) * CHUNK_SECTION_H);
+    int yBegin = begin;
+    int yEnd = end;
+    sectionOrigin = vec3(0.0f, section * CHUNK_SECTION_H, 0.0f);
+    buildLights(yBegin, yEnd);
+    begin *= CHUNK_W * CHUNK_D;
+    end *= CHUNK_W * CHUNK_D;
+    bool greedy = settings->graphics.greedyMeshing.get();
     for (const auto drawGroup : *content->drawGroups) {
+        buildOpenMasks(drawGroup, yBegin, yEnd);
+        uint32_t exposed = 0;
+        int exposedRow = -1;
+        if (greedy) {
+            greedyCubes(voxels, section, drawGroup);
+            if (overflow) {
+                return;
+            }
+        }
         for (int i = begin; i < end; i++) {
             const voxel& vox = voxels[i];
             blockid_t id = vox.id;
@@ -489,6 +807,20 @@ void BlocksRenderer::render(const voxel* voxels) {
             if (id == 0 || def.drawGroup != drawGroup || state.segment) {
                 continue;
             }
+            if (greedy && is_greedy_cube(def, state)) {
+                continue;
+            }
+            int x = i % CHUNK_W;
+            int y = i / (CHUNK_D * CHUNK_W);
+            int z = (i / CHUNK_D) % CHUNK_W;
+            if (i / CHUNK_W != exposedRow) {
+                exposedRow = i / CHUNK_W;
+                exposed = getExposedCells(y, z);
+            }
+            // cube with no neighbour visible through has no faces
+            if (def.model == BlockModel::block && !(exposed >> x & 1)) {
+                continue;
+            }
             const UVRegion texfaces[6] {
                 cache->getRegion(id, 0), 
                 cache->getRegion(id, 1),
@@ -497,9 +829,6 @@ void BlocksRenderer::render(const voxel* voxels) {
                 cache->getRegion(id, 4), 
                 cache->getRegion(id, 5)
             };
-            int x = i % CHUNK_W;
-            int y = i / (CHUNK_D * CHUNK_W);
-            int z = (i / CHUNK_D) % CHUNK_W;
             switch (def.model) {
                 case BlockModel::block:
                     blockCube(x, y, z, texfaces, &def, vox.state, !def.shadeless,
@@ -530,30 +859,74 @@ void BlocksRenderer::render(const voxel* voxels) {
     }
 }
 
-void BlocksRenderer::build(const Chunk* chunk, const ChunksStorage* chunks) {
-    this->chunk = chunk;
+void BlocksRenderer::build(const ChunksSnapshot& snapshot, uint sections) {
+    chunk = &snapshot.getCenter();
     voxelsBuffer->setPosition(
         chunk->x * CHUNK_W - voxelBufferPadding, 0,
         chunk->z * CHUNK_D - voxelBufferPadding);
-    chunks->getVoxels(voxelsBuffer.get(), settings->graphics.backlight.get());
+    snapshot.getVoxels(
+        voxelsBuffer.get(),
+        settings->graphics.backlight.get() ? &lightPassing : nullptr
+    );
     overflow = false;
     vertexOffset = 0;
-    indexOffset = indexSize = 0;
-    const voxel* voxels = chunk->voxels;
-    render(voxels);
+    indexSize = 0;
+    // sections data is put to the buffers one after another
+    for (int s = 0; s < CHUNK_SECTIONS; s++) {
+        auto& range = sectionRanges[s];
+        range.vertexStart = vertexOffset;
+        range.indexStart = indexSize;
+        // indices are relative to the section first vertex
+        indexOffset = 0;
+        if ((sections >> s & 1) && !overflow) {
+            render(chunk->voxels, s);
+        }
+        range.vertexEnd = vertexOffset;
+        range.indexEnd = indexSize;
+    }
 }
 
-std::shared_ptr<Mesh> BlocksRenderer::createMesh() {
-    const vattr attrs[]{ {3}, {2}, {1}, {0} };
-    size_t vcount = vertexOffset / BlocksRenderer::VERTEX_SIZE;
+static std::shared_ptr<Mesh> create_section_mesh(
+    const uint32_t* vertices,
+    const int* indices,
+    const ChunkMeshData::SectionRange& range
+) {
+    if (range.indexEnd == range.indexStart) {
+        return nullptr;
+    }
+    // see ChunkVertex
+    const vattr attrs[]{ {2, true}, {1, true}, {0} };
+    size_t vcount = (range.vertexEnd - range.vertexStart) / ChunkVertex::SIZE;
     return std::make_shared<Mesh>(
-        vertexBuffer.get(), vcount, indexBuffer.get(), indexSize, attrs
+        reinterpret_cast<const float*>(vertices + range.vertexStart),
+        vcount,
+        indices + range.indexStart,
+        range.indexEnd - range.indexStart,
+        attrs
+    );
+}
+
+std::shared_ptr<Mesh> BlocksRenderer::createMesh(int section) {
+    return create_section_mesh(
+        vertexBuffer.get(), indexBuffer.get(), sectionRanges[section]
+    );
+}
+
+void BlocksRenderer::getMeshData(ChunkMeshData& dst) const {
+    // vectors capacity is kept, so a reused object is not reallocated
+    dst.vertices.assign(vertexBuffer.get(), vertexBuffer.get() + vertexOffset);
+    dst.indices.assign(indexBuffer.get(), indexBuffer.get() + indexSize);
+    std::copy(
+        std::begin(sectionRanges), std::end(sectionRanges), dst.sections
     );
 }
 
-std::shared_ptr<Mesh> BlocksRenderer::render(const Chunk* chunk, const ChunksStorage* chunks) {
-    build(chunk, chunks);
-    return createMesh();
+std::shared_ptr<Mesh> BlocksRenderer::createMesh(
+    const ChunkMeshData& data, int section
+) {
+    return create_section_mesh(
+        data.vertices.data(), data.indices.data(), data.sections[section]
+    );
 }
 
 VoxelsVolume* BlocksRenderer::getVoxelsBuffer() const {
@@ -5,6 +5,7 @@
 #include <vector>
 #include <memory>
 #include <glm/glm.hpp>
+#include <voxels/Chunk.hpp>
 #include <voxels/voxel.hpp>
 #include <typedefs.hpp>
 
@@ -14,30 +15,82 @@ class Block;
 class Chunk;
 class Chunks;
 class VoxelsVolume;
-class ChunksStorage;
+class ChunksSnapshot;
 class ContentGfxCache;
 struct EngineSettings;
 struct UVRegion;
 
+/// @brief Chunk sections mesh data copied from the renderer buffers,
+/// so meshes are created later while the renderer builds the next chunk
+struct ChunkMeshData {
+    /// @brief Section mesh data location in the buffers
+    struct SectionRange {
+        size_t vertexStart = 0, vertexEnd = 0;
+        size_t indexStart = 0, indexEnd = 0;
+    };
+    /// @brief Packed vertices (see ChunkVertex)
+    std::vector<uint32_t> vertices;
+    std::vector<int> indices;
+    SectionRange sections[CHUNK_SECTIONS];
+};
+
 class BlocksRenderer {
+    using SectionRange = ChunkMeshData::SectionRange;
+
     static const glm::vec3 SUN_VECTOR;
     static const uint VERTEX_SIZE;
     const Content* const content;
-    std::unique_ptr<float[]> vertexBuffer;
+    /// @brief Packed vertices (see ChunkVertex)
+    std::unique_ptr<uint32_t[]> vertexBuffer;
     std::unique_ptr<int[]> indexBuffer;
     size_t vertexOffset;
     size_t indexOffset, indexSize;
+    SectionRange sectionRanges[CHUNK_SECTIONS];
+    /// @brief Origin of the section being built. Vertices positions are
+    /// relative to it, so they fit the packed vertex
+    glm::vec3 sectionOrigin {};
     size_t capacity;
     int voxelBufferPadding = 2;
     bool overflow = false;
-    const Chunk* chunk = nullptr;
+    const ChunkSnapshot* chunk = nullptr;
     std::unique_ptr<VoxelsVolume> voxelsBuffer;
+    /// @brief Block lightPassing flags by id used for backlight
+    std::vector<bool> lightPassing;
+    /// @brief Tables by draw group: 1 if the group blocks faces are
+    /// visible through the block of the id. BLOCK_VOID is the last entry
+    std::vector<ubyte> openTables[256];
+    /// @brief Bitmasks of the voxels buffer rows cells visible through
+    /// (bit x of row (y + 1) * depth + z) for the draw group being built.
+    /// Rows under and above the chunk are kept zero
+    std::unique_ptr<uint32_t[]> openMasks;
+    /// @brief 1 if light is picked from the block of the id.
+    /// BLOCK_VOID is the last entry
+    std::vector<ubyte> lightOpenTable;
+    /// @brief Voxels buffer lights of the cells light is picked from
+    /// (zero for the rest) with channels spread to bytes (see buildLights)
+    std::unique_ptr<uint32_t[]> lightsBuffer;
+    /// @brief Range of the voxels buffer rows lightsBuffer is built for
+    int lightsBegin = 0, lightsEnd = 0;
+    /// @brief Block sides atlas regions in texels (see ChunkVertex::region)
+    /// by id * 6 + side. Zero if the region can't be repeated on tiled faces
+    std::vector<glm::uvec4> tiledRegions;
 
     const Block* const* blockDefsCache;
     const ContentGfxCache* const cache;
     const EngineSettings* settings;
 
     void vertex(const glm::vec3& coord, float u, float v, const glm::vec4& light);
+    /// @brief Add vertex of a tiled face
+    /// @param u,v texture coord in tiles of the region (in the atlas
+    /// if the region is zero)
+    /// @param light compressed RGBA8 light
+    /// @param region atlas region in texels, zero for regular face
+    void vertexTiled(
+        const glm::vec3& coord,
+        float u, float v,
+        uint32_t light,
+        const glm::uvec4& region
+    );
     void index(int a, int b, int c, int d, int e, int f);
 
     void vertexAO(
@@ -84,6 +137,22 @@ class BlocksRenderer {
         const UVRegion& texreg,
         bool lights
     );
+    /// @brief Add faces of the section cube blocks merging coplanar faces
+    /// with the same texture and lights (greedy meshing)
+    void greedyCubes(const ChunkVoxels& voxels, int section, ubyte drawGroup);
+    /// @brief Add face of w*h blocks with the texture repeated per block
+    /// @param tiled the texture region in texels, zero if the face is of
+    /// a single block and the texture can't be repeated
+    void greedyFace(
+        const glm::vec3& coord,
+        const glm::ivec3& X,
+        const glm::ivec3& Y,
+        const glm::ivec3& Z,
+        int w, int h,
+        const UVRegion& region,
+        const glm::uvec4& tiled,
+        const uint32_t(&lights)[4]
+    );
     void blockCube(
         int x, int y, int z, 
         const UVRegion(&faces)[6], 
@@ -115,21 +184,47 @@ class BlocksRenderer {
         bool ao
     );
 
-    bool isOpenForLight(int x, int y, int z) const;
-    bool isOpen(int x, int y, int z, ubyte group) const;
+    /// @brief Check if the block faces are visible through the cell
+    /// (see buildOpenMasks). Cell must be in the chunk or next to it
+    bool isOpen(int x, int y, int z) const;
+    /// @brief Build open masks of the rows in [yBegin - 1, yEnd] range
+    /// for the draw group
+    void buildOpenMasks(ubyte group, int yBegin, int yEnd);
+    /// @return bits of the row cells having any neighbour visible through
+    /// (bit x is chunk local x)
+    uint32_t getExposedCells(int y, int z) const;
+
+    /// @brief Build lightsBuffer rows in [yBegin - 1, yEnd] range
+    void buildLights(int yBegin, int yEnd);
+    /// @return cell light with channels spread to bytes, zero if light
+    /// is not picked from the cell
+    uint32_t pickSpreadLight(int x, int y, int z) const;
 
     glm::vec4 pickLight(int x, int y, int z) const;
     glm::vec4 pickLight(const glm::ivec3& coord) const;
     glm::vec4 pickSoftLight(const glm::ivec3& coord, const glm::ivec3& right, const glm::ivec3& up) const;
     glm::vec4 pickSoftLight(float x, float y, float z, const glm::ivec3& right, const glm::ivec3& up) const;
-    void render(const voxel* voxels);
+    void render(const ChunkVoxels& voxels, int section);
 public:
     BlocksRenderer(size_t capacity, const Content* content, const ContentGfxCache* cache, const EngineSettings* settings);
     virtual ~BlocksRenderer();
 
-    void build(const Chunk* chunk, const ChunksStorage* chunks);
-    std::shared_ptr<Mesh> render(const Chunk* chunk, const ChunksStorage* chunks);
-    std::shared_ptr<Mesh> createMesh();
+    /// @brief Build meshes of the snapshot center chunk sections
+    /// @param sections bitmask of sections to build
+    void build(const ChunksSnapshot& snapshot, uint sections);
+
+    /// @brief Create mesh of the section built
+    /// @return mesh or nullptr if section has no faces
+    std::shared_ptr<Mesh> createMesh(int section);
+
+    /// @brief Copy data of the sections built to reuse the buffers
+    void getMeshData(ChunkMeshData& dst) const;
+
+    /// @brief Create mesh of the section from the copied data
+    /// @return mesh or nullptr if section has no faces
+    static std::shared_ptr<Mesh> createMesh(
+        const ChunkMeshData& data, int section
+    );
     VoxelsVolume* getVoxelsBuffer() const;
 };
 
@@ -0,0 +1,140 @@
+#ifndef GRAPHICS_RENDER_CHUNK_VERTEX_HPP_
+#define GRAPHICS_RENDER_CHUNK_VERTEX_HPP_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include <typedefs.hpp>
+
+/// @brief Chunk mesh vertex. Packed to 3 words (12 bytes): 64 bits of
+/// geometry (low word first) and light (RGBA8, red in the high byte).
+/// Position is relative to the chunk section origin.
+///
+/// Geometry bits of regular faces:
+/// - [0] 0
+/// - [1..33] x, y, z by 11 bits (fixed-point, see POSITION_SCALE)
+/// - [34..63] u, v by 15 bits (unorm texture coord)
+///
+/// Geometry bits of tiled faces (block corners only):
+/// - [0] 1
+/// - [1..15] x, y, z by 5 bits (position + 0.5 in blocks)
+/// - [16..37] atlas region start x, y by 11 bits (texels)
+/// - [38..53] atlas region width, height by 8 bits (texels)
+/// - [54..63] u, v by 5 bits (texture coord in tiles)
+///
+/// Must match the main shader attributes decoding
+struct ChunkVertex {
+    /// @brief Position relative to the section origin
+    glm::vec3 position;
+    /// @brief Texture coord in the atlas (or in tiles for tiled faces)
+    glm::vec2 uv;
+    /// @brief Atlas region (x, y, width, height) in texels repeated on
+    /// tiled faces, all zero for regular faces
+    glm::uvec4 region {};
+    /// @brief Compressed RGBA8 light
+    uint32_t light = 0;
+
+    /// @brief Number of 32 bit words in a packed vertex
+    static constexpr uint SIZE = 3;
+    /// @brief Position precision is 1/POSITION_SCALE of a block
+    static constexpr float POSITION_SCALE = 64.0f;
+    /// @brief Min position coordinate. Max is 2047/POSITION_SCALE greater
+    static constexpr float POSITION_MIN = -8.0f;
+    /// @brief Max tiled face position coordinate + 0.5
+    static constexpr uint MAX_TILED_POSITION = 31;
+    /// @brief Max atlas width and height tiled faces can be built with
+    static constexpr uint MAX_ATLAS_SIZE = 2048;
+    /// @brief Max width and height of region repeated on tiled faces
+    static constexpr uint MAX_REGION_SIZE = 255;
+    /// @brief Max number of region repeats along a tiled face side
+    static constexpr uint MAX_TILES = 31;
+
+    inline bool isTiled() const {
+        return region.z != 0;
+    }
+
+    void pack(uint32_t* dst) const {
+        uint64_t bits;
+        if (isTiled()) {
+            bits = 1;
+            for (int i = 0; i < 3; i++) {
+                bits |= pack_tiled_position(position[i]) << (1 + i * 5);
+            }
+            bits |= static_cast<uint64_t>(region.x & 0x7FF) << 16;
+            bits |= static_cast<uint64_t>(region.y & 0x7FF) << 27;
+            bits |= static_cast<uint64_t>(region.z & 0xFF) << 38;
+            bits |= static_cast<uint64_t>(region.w & 0xFF) << 46;
+            bits |= (static_cast<uint64_t>(uv.x) & MAX_TILES) << 54;
+            bits |= (static_cast<uint64_t>(uv.y) & MAX_TILES) << 59;
+        } else {
+            bits = 0;
+            for (int i = 0; i < 3; i++) {
+                bits |= pack_position(position[i]) << (1 + i * 11);
+            }
+            bits |= pack_unorm15(uv.x) << 34;
+            bits |= pack_unorm15(uv.y) << 49;
+        }
+        dst[0] = static_cast<uint32_t>(bits);
+        dst[1] = static_cast<uint32_t>(bits >> 32);
+        dst[2] = light;
+    }
+
+    static ChunkVertex unpack(const uint32_t* src) {
+        uint64_t bits = src[0] | static_cast<uint64_t>(src[1]) << 32;
+        ChunkVertex vertex {};
+        if (bits & 1) {
+            for (int i = 0; i < 3; i++) {
+                vertex.position[i] =
+                    static_cast<float>((bits >> (1 + i * 5)) & 0x1F) - 0.5f;
+            }
+            vertex.region = glm::uvec4(
+                (bits >> 16) & 0x7FF,
+                (bits >> 27) & 0x7FF,
+                (bits >> 38) & 0xFF,
+                (bits >> 46) & 0xFF
+            );
+            vertex.uv = glm::vec2((bits >> 54) & MAX_TILES, bits >> 59);
+        } else {
+            for (int i = 0; i < 3; i++) {
+                vertex.position[i] =
+                    unpack_position((bits >> (1 + i * 11)) & 0x7FF);
+            }
+            vertex.uv = glm::vec2(
+                unpack_unorm15((bits >> 34) & 0x7FFF),
+                unpack_unorm15((bits >> 49) & 0x7FFF)
+            );
+        }
+        vertex.light = src[2];
+        return vertex;
+    }
+private:
+    static inline uint64_t pack_position(float value) {
+        float fixed = std::round((value - POSITION_MIN) * POSITION_SCALE);
+        return static_cast<uint64_t>(std::clamp(fixed, 0.0f, 2047.0f));
+    }
+
+    static inline float unpack_position(uint64_t value) {
+        return value / POSITION_SCALE + POSITION_MIN;
+    }
+
+    static inline uint64_t pack_tiled_position(float value) {
+        float fixed = std::round(value + 0.5f);
+        return static_cast<uint64_t>(
+            std::clamp(fixed, 0.0f, static_cast<float>(MAX_TILED_POSITION))
+        );
+    }
+
+    static inline uint64_t pack_unorm15(float value) {
+        return static_cast<uint64_t>(
+            std::round(std::clamp(value, 0.0f, 1.0f) * 0x7FFF)
+        );
+    }
+
+    static inline float unpack_unorm15(uint64_t value) {
+        return value / static_cast<float>(0x7FFF);
+    }
+};
+
+#endif  // GRAPHICS_RENDER_CHUNK_VERTEX_HPP_
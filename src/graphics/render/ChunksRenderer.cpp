@@ -3,10 +3,14 @@
 #include <debug/Logger.hpp>
 #include <graphics/core/Mesh.hpp>
 #include <voxels/Chunk.hpp>
+#include <voxels/ChunksSnapshot.hpp>
 #include <world/Level.hpp>
 #include <settings.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <thread>
 #include <glm/glm.hpp>
 #include <glm/ext.hpp>
 
@@ -14,21 +18,67 @@ static debug::Logger logger("chunks-render");
 
 const uint RENDERER_CAPACITY = 9 * 6 * 6 * 3000;
 
-class RendererWorker : public util::Worker<Chunk, RendererResult> {
-    Level* level;
+/// @brief Snapshot of the chunk to build meshes of the sections
+struct RendererJob {
+    /// @brief Unique id of the job. Chunk version is not used to match
+    /// results as it restarts when the chunk is reloaded
+    uint64_t id;
+    ChunksSnapshot snapshot;
+    /// @brief Bitmask of sections to build
+    uint sections;
+    /// @brief Set by the main thread if the result is not needed anymore
+    std::atomic<bool> cancelled = false;
+
+    RendererJob(uint64_t id, ChunksSnapshot snapshot, uint sections)
+        : id(id), snapshot(std::move(snapshot)), sections(sections) {
+    }
+};
+
+static void update_mesh(
+    ChunkMesh& mesh, BlocksRenderer& renderer, uint sections
+) {
+    for (int s = 0; s < CHUNK_SECTIONS; s++) {
+        if (sections >> s & 1) {
+            mesh.sections[s] = renderer.createMesh(s);
+        }
+    }
+}
+
+static void update_mesh(
+    ChunkMesh& mesh, const ChunkMeshData& data, uint sections
+) {
+    for (int s = 0; s < CHUNK_SECTIONS; s++) {
+        if (sections >> s & 1) {
+            mesh.sections[s] = BlocksRenderer::createMesh(data, s);
+        }
+    }
+}
+
+class RendererWorker : public util::Worker<RendererJob, RendererResult> {
     BlocksRenderer renderer;
+    util::ObjectsPool<ChunkMeshData>& dataPool;
 public:
     RendererWorker(
         Level* level, 
         const ContentGfxCache* cache, 
-        const EngineSettings* settings
-    ) : level(level), 
-        renderer(RENDERER_CAPACITY, level->content, cache, settings)
+        const EngineSettings* settings,
+        util::ObjectsPool<ChunkMeshData>& dataPool
+    ) : renderer(RENDERER_CAPACITY, level->content, cache, settings),
+        dataPool(dataPool)
     {}
 
-    RendererResult operator()(const std::shared_ptr<Chunk>& chunk) override {
-        renderer.build(chunk.get(), level->chunksStorage.get());
-        return RendererResult {glm::ivec2(chunk->x, chunk->z), &renderer};
+    RendererResult operator()(
+        const std::shared_ptr<RendererJob>& job
+    ) override {
+        const auto& chunk = job->snapshot.getCenter();
+        glm::ivec2 key(chunk.x, chunk.z);
+        if (job->cancelled) {
+            return RendererResult {key, job->id, nullptr};
+        }
+        renderer.build(job->snapshot, job->sections);
+        auto data = dataPool.acquire();
+        renderer.getMeshData(*data);
+        return RendererResult {key, job->id, std::move(data)};
     }
 };
 
@@ -37,67 +87,165 @@ ChunksRenderer::ChunksRenderer(
     const ContentGfxCache* cache, 
     const EngineSettings* settings
 ) : level(level),
+    // a data object per job in work (see maxJobs)
+    meshDataPool(std::thread::hardware_concurrency() * 2),
     threadPool(
         "chunks-render-pool",
-        [=](){return std::make_shared<RendererWorker>(level, cache, settings);}, 
-        [=](RendererResult& mesh){
-            meshes[mesh.key] = mesh.renderer->createMesh();
-            inwork.erase(mesh.key);
+        [=](){
+            return std::make_shared<RendererWorker>(
+                level, cache, settings, meshDataPool
+            );
+        }, 
+        [=](RendererResult& result){
+            auto found = inwork.find(result.key);
+            // skip result of a job outdated by the main thread render or
+            // by the chunk unload
+            if (result.data == nullptr || found == inwork.end() ||
+                found->second.job->id != result.jobId) {
+                return;
+            }
+            auto& work = found->second;
+            update_mesh(meshes[result.key], *result.data, work.sections);
+            stats.latency = (stats.latency * 15 + work.timer.stop()) / 16;
+            inwork.erase(found);
         })
 {
-    threadPool.setStandaloneResults(false);
     threadPool.setStopOnFail(false);
     renderer = std::make_unique<BlocksRenderer>(
         RENDERER_CAPACITY, level->content, cache, settings
     );
+    // a job per worker and the next one waiting for it
+    maxJobs = threadPool.getWorkersCount() * 2;
     logger.info() << "created " << threadPool.getWorkersCount() << " workers";
 }
 
 ChunksRenderer::~ChunksRenderer() {
 }
 
-std::shared_ptr<Mesh> ChunksRenderer::render(const std::shared_ptr<Chunk>& chunk, bool important) {
-    chunk->flags.modified = false;
-    if (important) {
-        auto mesh = renderer->render(chunk.get(), level->chunksStorage.get());
-        meshes[glm::ivec2(chunk->x, chunk->z)] = mesh;
-        return mesh;
-    }
+void ChunksRenderer::cancel(
+    std::unordered_map<glm::ivec2, Work>::iterator work
+) {
+    work->second.job->cancelled = true;
+    inwork.erase(work);
+    stats.cancelled++;
+}
+
+const ChunkMesh* ChunksRenderer::render(
+    const std::shared_ptr<Chunk>& chunk, bool important, float priority
+) {
     glm::ivec2 key(chunk->x, chunk->z);
-    if (inwork.find(key) != inwork.end()) {
+    if (!important) {
+        auto found = requests.find(key);
+        if (found == requests.end()) {
+            requests[key] = Request {chunk, priority, {}};
+        } else {
+            found->second.priority = priority;
+        }
         return nullptr;
     }
-    inwork[key] = true;
-    threadPool.enqueueJob(chunk);
-    return nullptr;
+    requests.erase(key);
+    uint sections = chunk->modifiedSections;
+    if (meshes.find(key) == meshes.end()) {
+        sections = CHUNK_ALL_SECTIONS;
+    }
+    auto work = inwork.find(key);
+    if (work != inwork.end()) {
+        sections |= work->second.sections;
+        cancel(work);
+    }
+    chunk->modifiedSections = 0;
+    ChunksSnapshot snapshot(*level->chunksStorage, *chunk);
+    renderer->build(snapshot, sections);
+    auto& mesh = meshes[key];
+    update_mesh(mesh, *renderer, sections);
+    return &mesh;
 }
 
 void ChunksRenderer::unload(const Chunk* chunk) {
-    auto found = meshes.find(glm::ivec2(chunk->x, chunk->z));
+    glm::ivec2 key(chunk->x, chunk->z);
+    auto found = meshes.find(key);
     if (found != meshes.end()) {
         meshes.erase(found);
     }
+    requests.erase(key);
+    auto work = inwork.find(key);
+    if (work != inwork.end()) {
+        cancel(work);
+    }
 }
 
-std::shared_ptr<Mesh> ChunksRenderer::getOrRender(const std::shared_ptr<Chunk>& chunk, bool important) {
+const ChunkMesh* ChunksRenderer::getOrRender(
+    const std::shared_ptr<Chunk>& chunk, bool important, float priority
+) {
     auto found = meshes.find(glm::ivec2(chunk->x, chunk->z));
     if (found == meshes.end()) {
-        return render(chunk, important);
+        return render(chunk, important, priority);
     }
-    if (chunk->flags.modified) {
-        render(chunk, important);
+    if (chunk->isModified()) {
+        render(chunk, important, priority);
     }
-    return found->second;
+    return &found->second;
 }
 
-std::shared_ptr<Mesh> ChunksRenderer::get(Chunk* chunk) {
+const ChunkMesh* ChunksRenderer::get(Chunk* chunk) {
     auto found = meshes.find(glm::ivec2(chunk->x, chunk->z));
     if (found != meshes.end()) {
-        return found->second;
+        return &found->second;
     }
     return nullptr;
 }
 
+void ChunksRenderer::enqueueJob(const glm::ivec2& key, Request& request) {
+    auto chunk = request.chunk.lock();
+    uint sections = chunk->modifiedSections;
+    if (meshes.find(key) == meshes.end()) {
+        sections = CHUNK_ALL_SECTIONS;
+    }
+    chunk->modifiedSections = 0;
+    auto job = std::make_shared<RendererJob>(
+        nextJobId++, ChunksSnapshot(*level->chunksStorage, *chunk), sections
+    );
+    inwork[key] = Work {sections, job, request.timer};
+    threadPool.enqueueJob(job);
+}
+
+void ChunksRenderer::enqueueJobs() {
+    std::vector<std::pair<float, glm::ivec2>> queue;
+    for (auto it = requests.begin(); it != requests.end();) {
+        if (it->second.chunk.expired()) {
+            it = requests.erase(it);
+            continue;
+        }
+        // chunk modified while in work waits for the job to be done
+        if (inwork.find(it->first) == inwork.end()) {
+            queue.emplace_back(it->second.priority, it->first);
+        }
+        ++it;
+    }
+    size_t count = std::min(queue.size(), maxJobs - inwork.size());
+    std::partial_sort(
+        queue.begin(),
+        queue.begin() + count,
+        queue.end(),
+        [](const auto& a, const auto& b) { return a.first < b.first; }
+    );
+    for (size_t i = 0; i < count; i++) {
+        const auto& key = queue[i].second;
+        auto found = requests.find(key);
+        enqueueJob(key, found->second);
+        requests.erase(found);
+    }
+}
+
 void ChunksRenderer::update() {
     threadPool.update();
+    if (inwork.size() < maxJobs && !requests.empty()) {
+        enqueueJobs();
+    }
+    stats.queued = requests.size();
+    stats.inwork = inwork.size();
+}
+
+const ChunksMeshingStats& ChunksRenderer::getStats() const {
+    return stats;
 }
@@ -6,30 +6,95 @@
 #include <vector>
 #include <unordered_map>
 #include <glm/glm.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
 
+#include <constants.hpp>
 #include <voxels/Block.hpp>
 #include <voxels/ChunksStorage.hpp>
+#include <util/ObjectsPool.hpp>
 #include <util/ThreadPool.hpp>
+#include <util/timeutil.hpp>
 
 class Mesh;
 class Chunk;
+class ChunksSnapshot;
 class Level;
 class BlocksRenderer;
 class ContentGfxCache;
 struct EngineSettings;
+struct RendererJob;
+struct ChunkMeshData;
 
 struct RendererResult {
     glm::ivec2 key;
-    BlocksRenderer* renderer;
+    /// @brief Id of the job the mesh is built by (see RendererJob::id)
+    uint64_t jobId;
+    /// @brief Built sections data owned by the result, so the worker
+    /// takes the next job without waiting for the result to be applied.
+    /// nullptr if the job was cancelled
+    std::shared_ptr<ChunkMeshData> data;
+};
+
+/// @brief Chunk mesh split by sections, so a section is remeshed
+/// without the rest of the chunk
+struct ChunkMesh {
+    /// @brief Sections meshes, nullptr if section has no faces
+    std::shared_ptr<Mesh> sections[CHUNK_SECTIONS];
+};
+
+/// @brief Chunks meshing queue metrics
+struct ChunksMeshingStats {
+    /// @brief Number of chunks waiting for a meshing job
+    size_t queued = 0;
+    /// @brief Number of meshing jobs in work
+    size_t inwork = 0;
+    /// @brief Moving average of time from the first mesh request to the
+    /// mesh update (microseconds)
+    int64_t latency = 0;
+    /// @brief Number of jobs cancelled (chunk unloaded or remeshed on the
+    /// main thread)
+    size_t cancelled = 0;
 };
 
 class ChunksRenderer {
+    /// @brief Chunk waiting for a meshing job
+    struct Request {
+        std::weak_ptr<Chunk> chunk;
+        /// @brief Lower value is meshed first
+        float priority;
+        /// @brief Time since the first request
+        timeutil::Timer timer;
+    };
+    /// @brief Meshing job in work
+    struct Work {
+        /// @brief Bitmask of sections being meshed
+        uint sections;
+        std::shared_ptr<RendererJob> job;
+        timeutil::Timer timer;
+    };
     Level* level;
     std::unique_ptr<BlocksRenderer> renderer;
-    std::unordered_map<glm::ivec2, std::shared_ptr<Mesh>> meshes;
-    std::unordered_map<glm::ivec2, bool> inwork;
+    std::unordered_map<glm::ivec2, ChunkMesh> meshes;
+    std::unordered_map<glm::ivec2, Request> requests;
+    std::unordered_map<glm::ivec2, Work> inwork;
+    /// @brief Max number of jobs in work. Requests are kept until a job
+    /// may be started, so the latest chunk state is meshed and
+    /// priorities updated after a job is enqueued are not ignored
+    size_t maxJobs;
+    /// @brief Id of the next enqueued job
+    uint64_t nextJobId = 1;
+    /// @brief Results data reused by the workers. Declared before the
+    /// pool to outlive the results
+    util::ObjectsPool<ChunkMeshData> meshDataPool;
 
-    util::ThreadPool<Chunk, RendererResult> threadPool;
+    util::ThreadPool<RendererJob, RendererResult> threadPool;
+    ChunksMeshingStats stats {};
+
+    void cancel(std::unordered_map<glm::ivec2, Work>::iterator work);
+    void enqueueJob(const glm::ivec2& key, Request& request);
+    /// @brief Start jobs for the requests having the lowest priority values
+    void enqueueJobs();
 public:
     ChunksRenderer(
         Level* level, 
@@ -38,13 +103,27 @@ public:
     );
     virtual ~ChunksRenderer();
 
-    std::shared_ptr<Mesh> render(const std::shared_ptr<Chunk>& chunk, bool important);
+    /// @brief Remesh modified sections of the chunk (all if there is no
+    /// mesh yet). Repeated requests of a chunk are merged to a single job
+    /// @param important build on the current thread instead of workers
+    /// @param priority jobs with lower value are started first, updated
+    /// by every request until the job is started
+    /// @return chunk mesh if built on the current thread
+    const ChunkMesh* render(
+        const std::shared_ptr<Chunk>& chunk, bool important, float priority
+    );
+    /// @brief Remove chunk mesh, requests and cancel jobs in work
     void unload(const Chunk* chunk);
 
-    std::shared_ptr<Mesh> getOrRender(const std::shared_ptr<Chunk>& chunk, bool important);
-    std::shared_ptr<Mesh> get(Chunk* chunk);
+    const ChunkMesh* getOrRender(
+        const std::shared_ptr<Chunk>& chunk, bool important, float priority
+    );
+    const ChunkMesh* get(Chunk* chunk);
 
+    /// @brief Apply finished jobs results and start jobs for requests
     void update();
+
+    const ChunksMeshingStats& getStats() const;
 };
 
 #endif // GRAPHICS_RENDER_CHUNKSRENDERER_HPP_
@@ -46,6 +46,10 @@
 bool WorldRenderer::showChunkBorders = false;
 bool WorldRenderer::showEntitiesDebug = false;
 
+/// @brief Added to the meshing priority of chunks out of view, so they
+/// are meshed after all visible chunks
+static constexpr float HIDDEN_CHUNKS_PRIORITY = 1e6f;
+
 WorldRenderer::WorldRenderer(
     Engine* engine, LevelFrontend* frontend, Player* player
 )
@@ -76,6 +80,10 @@ WorldRenderer::WorldRenderer(
 
 WorldRenderer::~WorldRenderer() = default;
 
+const ChunksRenderer* WorldRenderer::getChunksRenderer() const {
+    return renderer.get();
+}
+
 bool WorldRenderer::drawChunk(
     size_t index, Camera* camera, Shader* shader, bool culling
 ) {
@@ -91,24 +99,54 @@ bool WorldRenderer::drawChunk(
             (chunk->z + 0.5f) * CHUNK_D
         )
     );
-    auto mesh = renderer->getOrRender(chunk, distance < CHUNK_W * 1.5f);
-    if (mesh == nullptr) {
+    glm::vec3 min(chunk->x * CHUNK_W, chunk->bottom, chunk->z * CHUNK_D);
+    glm::vec3 max(
+        chunk->x * CHUNK_W + CHUNK_W,
+        chunk->top,
+        chunk->z * CHUNK_D + CHUNK_D
+    );
+    bool visible = !culling || frustumCulling->isBoxVisible(min, max);
+    float priority = visible ? distance : distance + HIDDEN_CHUNKS_PRIORITY;
+    auto mesh = renderer->getOrRender(
+        chunk, distance < CHUNK_W * 1.5f, priority
+    );
+    if (mesh == nullptr || !visible) {
         return false;
     }
-    if (culling) {
-        glm::vec3 min(chunk->x * CHUNK_W, chunk->bottom, chunk->z * CHUNK_D);
-        glm::vec3 max(
-            chunk->x * CHUNK_W + CHUNK_W,
-            chunk->top,
-            chunk->z * CHUNK_D + CHUNK_D
+    auto drawSection = [&](int section) {
+        const auto& sectionMesh = mesh->sections[section];
+        if (sectionMesh == nullptr) {
+            return;
+        }
+        if (culling) {
+            min.y = section * CHUNK_SECTION_H;
+            max.y = min.y + CHUNK_SECTION_H;
+            if (!frustumCulling->isBoxVisible(min, max)) return;
+        }
+        // vertices positions are relative to the section (see ChunkVertex)
+        glm::vec3 coord(
+            chunk->x * CHUNK_W + 0.5f,
+            section * CHUNK_SECTION_H + 0.5f,
+            chunk->z * CHUNK_D + 0.5f
         );
-
-        if (!frustumCulling->isBoxVisible(min, max)) return false;
+        shader->uniformMatrix(
+            "u_model", glm::translate(glm::mat4(1.0f), coord)
+        );
+        sectionMesh->draw();
+    };
+    // sections are drawn from the farthest to the nearest one
+    int cameraSection = std::clamp(
+        static_cast<int>(std::floor(camera->position.y / CHUNK_SECTION_H)),
+        0,
+        CHUNK_SECTIONS - 1
+    );
+    for (int section = 0; section < cameraSection; section++) {
+        drawSection(section);
+    }
+    for (int section = CHUNK_SECTIONS - 1; section >= cameraSection;
+         section--) {
+        drawSection(section);
     }
-    glm::vec3 coord(chunk->x * CHUNK_W + 0.5f, 0.5f, chunk->z * CHUNK_D + 0.5f);
-    glm::mat4 model = glm::translate(glm::mat4(1.0f), coord);
-    shader->uniformMatrix("u_model", model);
-    mesh->draw();
     return true;
 }
 
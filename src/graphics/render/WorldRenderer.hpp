@@ -86,6 +86,8 @@ public:
     );
     void drawBorders(int sx, int sy, int sz, int ex, int ey, int ez);
 
+    const ChunksRenderer* getChunksRenderer() const;
+
     /// @brief Render level without diegetic interface
     /// @param context graphics context
     /// @param camera active camera
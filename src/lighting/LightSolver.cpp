@@ -21,7 +21,7 @@ void LightSolver::add(int x, int y, int z, int emission) {
 	addqueue.push(lightentry {x, y, z, ubyte(emission)});
 
 	Chunk* chunk = chunks->getChunkByVoxel(x, y, z);
-    chunk->flags.modified = true;
+    chunk->setModified(y);
 	chunk->lightmap.set(x-chunk->x*CHUNK_W, y, z-chunk->z*CHUNK_D, channel, emission);
 }
 
@@ -67,7 +67,7 @@ void LightSolver::solve(){
 			if (chunk) {
 				int lx = x - chunk->x * CHUNK_W;
 				int lz = z - chunk->z * CHUNK_D;
-                chunk->flags.modified = true;
+                chunk->setModified(y);
 
 				ubyte light = chunk->lightmap.get(lx,y,lz, channel);
 				if (light != 0 && light == entry.light-1){
@@ -96,10 +96,10 @@ void LightSolver::solve(){
 			if (chunk) {
 				int lx = x - chunk->x * CHUNK_W;
 				int lz = z - chunk->z * CHUNK_D;
-                chunk->flags.modified = true;
+                chunk->setModified(y);
 
 				ubyte light = chunk->lightmap.get(lx, y, lz, channel);
-				voxel& v = chunk->voxels[vox_index(lx, y, lz)];
+				const voxel& v = chunk->voxels[vox_index(lx, y, lz)];
 				const Block* block = blockDefs[v.id];
 				if (block->lightPassing && light+2 <= entry.light){
 					chunk->lightmap.set(
@@ -27,31 +27,43 @@ void Lighting::clear(){
         auto chunk = chunks->chunks[index];
         if (chunk == nullptr)
             continue;
-        Lightmap& lightmap = chunk->lightmap;
-        for (int i = 0; i < CHUNK_VOL; i++){
-            lightmap.map[i] = 0;
-        }
+        chunk->lightmap.clear();
     }
 }
 
 void Lighting::prebuildSkyLight(Chunk* chunk, const ContentIndices* indices){
     const auto* blockDefs = indices->blocks.getDefs();
 
+    // lowest voxel lit by sky of each column
+    int skyHeights[CHUNK_D * CHUNK_W];
     int highestPoint = 0;
     for (int z = 0; z < CHUNK_D; z++){
         for (int x = 0; x < CHUNK_W; x++){
-            for (int y = CHUNK_H-1; y >= 0; y--){
-                int index = (y * CHUNK_D + z) * CHUNK_W + x;
-                voxel& vox = chunk->voxels[index];
+            int y = CHUNK_H-1;
+            for (; y >= 0; y--){
+                const voxel& vox = chunk->voxels[vox_index(x, y, z)];
                 const Block* block = blockDefs[vox.id];
                 if (!block->skyLightPassing) {
                     if (highestPoint < y)
                         highestPoint = y;
                     break;
                 }
-                chunk->lightmap.setS(x,y,z, 15);
+            }
+            skyHeights[z * CHUNK_W + x] = y + 1;
+        }
+    }
+    // built by sections, so uniformly lit ones take no memory
+    const light_t skylight = Lightmap::combine(0, 0, 0, 15);
+    light_t lights[CHUNK_SECTION_VOL];
+    for (int s = 0; s < CHUNK_SECTIONS; s++){
+        for (int ly = 0; ly < CHUNK_SECTION_H; ly++){
+            int y = s * CHUNK_SECTION_H + ly;
+            light_t* row = lights + ly * CHUNK_D * CHUNK_W;
+            for (int i = 0; i < CHUNK_D * CHUNK_W; i++){
+                row[i] = y >= skyHeights[i] ? skylight : 0;
             }
         }
+        chunk->lightmap.setSection(s, lights);
     }
     if (highestPoint < CHUNK_H-1)
         highestPoint++;
@@ -160,7 +172,7 @@ void Lighting::onBlockSet(int x, int y, int z, blockid_t id){
         solverB->solve();
         if (chunks->getLight(x,y+1,z, 3) == 0xF){
             for (int i = y; i >= 0; i--){
-                voxel* vox = chunks->get(x,i,z);
+                const voxel* vox = chunks->get(x,i,z);
                 if ((vox == nullptr || vox->id != 0) && block.skyLightPassing)
                     break;
                 solverS->add(x,i,z, 0xF);
@@ -3,33 +3,136 @@
 #include <util/data_io.hpp>
 
 #include <assert.h>
+#include <algorithm>
+#include <cstring>
 
 void Lightmap::set(const Lightmap* lightmap) {
-    set(lightmap->map);
+    map = lightmap->map;
 }
 
 void Lightmap::set(const light_t* map) {
-    for (size_t i = 0; i < CHUNK_VOL; i++) {
-        this->map[i] = map[i];
-    }
+    this->map.assign(map);
+}
+
+void Lightmap::clear() {
+    map.fill(0);
+}
+
+void Lightmap::setSection(uint section, const light_t* lights) {
+    map.assignSection(section, lights);
 }
 
 static_assert(sizeof(light_t) == 2, "replace dataio calls to new light_t");
 
-std::unique_ptr<ubyte[]> Lightmap::encode() const {
-    auto buffer = std::make_unique<ubyte[]>(LIGHTMAP_DATA_LEN);
-    for (uint i = 0; i < CHUNK_VOL; i+=2) {
-        buffer[i/2] = ((map[i] >> 12) & 0xF) | ((map[i+1] >> 8) & 0xF0);
+/**
+  Only skylight is stored, as 4 bit values packed in pairs (lower bits
+  first).
+
+  Planar format: skylight of all voxels (LIGHTMAP_DATA_LEN bytes).
+
+  Sections format is used only if smaller than the planar one, so formats
+  are distinguished by the data length:
+
+    ```cpp
+    // skylight of uniform section or PACKED_SECTION
+    uint8_t sections[CHUNK_SECTIONS];
+    // skylight of not uniform sections
+    uint8_t data[SECTION_DATA_LEN * packed_sections_count];
+    ```
+*/
+inline constexpr ubyte PACKED_SECTION = 0xFF;
+inline constexpr uint SECTION_DATA_LEN = CHUNK_SECTION_VOL / 2;
+
+// Branchless loops below are vectorized by compiler
+
+static void pack_skylight(const light_t* src, ubyte* dst, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = (src[i * 2] >> 12) | ((src[i * 2 + 1] >> 8) & 0xF0);
+    }
+}
+
+static void unpack_skylight(const ubyte* src, light_t* dst, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        dst[i * 2] = (src[i] & 0xF) << 12;
+        dst[i * 2 + 1] = (src[i] & 0xF0) << 8;
+    }
+}
+
+/// @return skylight of the section voxels if the same for all of them,
+/// otherwise PACKED_SECTION
+static ubyte get_uniform_skylight(const LightmapSections& map, uint section) {
+    const light_t* src = map.getSection(section);
+    if (src == nullptr) {
+        return map.getFill(section) >> 12;
+    }
+    light_t first = src[0] & 0xF000;
+    light_t diff = 0;
+    for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+        diff |= (src[i] & 0xF000) ^ first;
+    }
+    return diff ? PACKED_SECTION : first >> 12;
+}
+
+std::unique_ptr<ubyte[]> Lightmap::encode(size_t& length) const {
+    ubyte sections[CHUNK_SECTIONS];
+    length = CHUNK_SECTIONS;
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        sections[s] = get_uniform_skylight(map, s);
+        if (sections[s] == PACKED_SECTION) {
+            length += SECTION_DATA_LEN;
+        }
+    }
+    if (length >= LIGHTMAP_DATA_LEN) {
+        length = LIGHTMAP_DATA_LEN;
+        auto lights = std::make_unique<light_t[]>(CHUNK_VOL);
+        map.copyTo(lights.get());
+        auto buffer = std::make_unique<ubyte[]>(LIGHTMAP_DATA_LEN);
+        pack_skylight(lights.get(), buffer.get(), LIGHTMAP_DATA_LEN);
+        return buffer;
+    }
+    auto buffer = std::make_unique<ubyte[]>(length);
+    std::memcpy(buffer.get(), sections, CHUNK_SECTIONS);
+    ubyte* dst = buffer.get() + CHUNK_SECTIONS;
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        if (sections[s] == PACKED_SECTION) {
+            pack_skylight(map.getSection(s), dst, SECTION_DATA_LEN);
+            dst += SECTION_DATA_LEN;
+        }
     }
     return buffer;
 }
 
-std::unique_ptr<light_t[]> Lightmap::decode(const ubyte* buffer) {
-    auto lights = std::make_unique<light_t[]>(CHUNK_VOL);
-    for (uint i = 0; i < CHUNK_VOL; i+=2) {
-        ubyte b = buffer[i/2];
-        lights[i] = ((b & 0xF) << 12);
-        lights[i+1] = ((b & 0xF0) << 8);
-    } 
+std::unique_ptr<light_t[]> Lightmap::decode(
+    const ubyte* buffer, size_t length
+) {
+    // all elements are written below
+    std::unique_ptr<light_t[]> lights(new light_t[CHUNK_VOL]);
+    if (length == LIGHTMAP_DATA_LEN) {
+        unpack_skylight(buffer, lights.get(), LIGHTMAP_DATA_LEN);
+        return lights;
+    }
+    if (length < CHUNK_SECTIONS) {
+        return nullptr;
+    }
+    const ubyte* src = buffer + CHUNK_SECTIONS;
+    const ubyte* end = buffer + length;
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        light_t* dst = lights.get() + s * CHUNK_SECTION_VOL;
+        ubyte skylight = buffer[s];
+        if (skylight == PACKED_SECTION) {
+            if (end - src < SECTION_DATA_LEN) {
+                return nullptr;
+            }
+            unpack_skylight(src, dst, SECTION_DATA_LEN);
+            src += SECTION_DATA_LEN;
+        } else if (skylight <= 0xF) {
+            std::fill(dst, dst + CHUNK_SECTION_VOL, skylight << 12);
+        } else {
+            return nullptr;
+        }
+    }
+    if (src != end) {
+        return nullptr;
+    }
     return lights;
 }
@@ -3,23 +3,37 @@
 
 #include <constants.hpp>
 #include <typedefs.hpp>
+#include <util/SparseSections.hpp>
 
 #include <memory>
 
 inline constexpr int LIGHTMAP_DATA_LEN = CHUNK_VOL/2;
 
+using LightmapSections =
+    util::SparseSections<light_t, CHUNK_SECTION_VOL, CHUNK_SECTIONS>;
+
 // Lichtkarte
 class Lightmap {
+    /// @brief Uniform sections (all dark or all lit by sky) are stored
+    /// as a single value
+    LightmapSections map;
 public:
-    light_t map[CHUNK_VOL] {};
     int highestPoint = 0;
 
     void set(const Lightmap* lightmap);
 
+    /// @param map lights of CHUNK_VOL voxels
     void set(const light_t* map);
 
+    /// @brief Set all lights to zero
+    void clear();
+
+    /// @brief Replace lights of the section
+    /// @param lights lights of CHUNK_SECTION_VOL voxels
+    void setSection(uint section, const light_t* lights);
+
     inline unsigned short get(int x, int y, int z) const {
-        return (map[y*CHUNK_D*CHUNK_W+z*CHUNK_W+x]);
+        return map[y*CHUNK_D*CHUNK_W+z*CHUNK_W+x];
     }
 
     inline unsigned char get(int x, int y, int z, int channel) const {
@@ -44,34 +58,30 @@ public:
 
     inline void setR(int x, int y, int z, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
-        map[index] = (map[index] & 0xFFF0) | value;
+        map.set(index, (map[index] & 0xFFF0) | value);
     }
 
     inline void setG(int x, int y, int z, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
-        map[index] = (map[index] & 0xFF0F) | (value << 4);
+        map.set(index, (map[index] & 0xFF0F) | (value << 4));
     }
 
     inline void setB(int x, int y, int z, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
-        map[index] = (map[index] & 0xF0FF) | (value << 8);
+        map.set(index, (map[index] & 0xF0FF) | (value << 8));
     }
 
     inline void setS(int x, int y, int z, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
-        map[index] = (map[index] & 0x0FFF) | (value << 12);
+        map.set(index, (map[index] & 0x0FFF) | (value << 12));
     }
 
     inline void set(int x, int y, int z, int channel, int value){
         const int index = y*CHUNK_D*CHUNK_W+z*CHUNK_W+x;
-        map[index] = (map[index] & (0xFFFF & (~(0xF << (channel*4))))) | (value << (channel << 2));
-    }
-
-    inline const light_t* getLights() const {
-        return map;
+        map.set(index, (map[index] & (0xFFFF & (~(0xF << (channel*4))))) | (value << (channel << 2)));
     }
 
-    inline light_t* getLightsWriteable() {
+    inline const LightmapSections& getSections() const {
         return map;
     }
 
@@ -83,8 +93,18 @@ public:
         return (light >> (channel << 2)) & 0xF;
     }
 
-    std::unique_ptr<ubyte[]> encode() const;
-    static std::unique_ptr<light_t[]> decode(const ubyte* buffer);
+    /// @brief Encode skylight in the sections format if it's smaller than
+    /// the planar one (LIGHTMAP_DATA_LEN bytes), otherwise in the planar
+    /// format
+    /// @param length (out argument) encoded data length
+    std::unique_ptr<ubyte[]> encode(size_t& length) const;
+
+    /// @brief Decode skylight in the planar or the sections format
+    /// @param length encoded data length
+    /// @return lights or nullptr if data is malformed
+    static std::unique_ptr<light_t[]> decode(
+        const ubyte* buffer, size_t length
+    );
 };
 
 #endif // LIGHTING_LIGHTMAP_HPP_
@@ -60,7 +60,7 @@ void BlocksController::placeBlock(
 }
 
 void BlocksController::updateBlock(int x, int y, int z) {
-    voxel* vox = chunks->get(x, y, z);
+    const voxel* vox = chunks->get(x, y, z);
     if (vox == nullptr) return;
     auto& def = level->content->getIndices()->blocks.require(vox->id);
     if (def.grounded) {
@@ -134,7 +134,7 @@ void BlocksController::randomTick(int tickid, int parts) {
             if ((index + tickid) % parts != 0) {
                 continue;
             }
-            auto& chunk = chunks->chunks[index];
+            auto& chunk = chunks->getLocal(x, z);
             if (chunk == nullptr || !chunk->flags.lighted) {
                 continue;
             }
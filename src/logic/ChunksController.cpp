@@ -2,6 +2,7 @@
 
 #include <limits.h>
 
+#include <cmath>
 #include <iostream>
 #include <memory>
 
@@ -22,6 +23,8 @@
 
 const uint MAX_WORK_PER_FRAME = 128;
 const uint MIN_SURROUNDING = 9;
+/// @brief Movement prediction time used to prefetch regions (seconds)
+const float PREFETCH_TIME = 2.0f;
 
 ChunksController::ChunksController(Level* level, uint padding)
     : level(level),
@@ -30,7 +33,8 @@ ChunksController::ChunksController(Level* level, uint padding)
       padding(padding),
       generator(WorldGenerators::createGenerator(
           level->getWorld()->getGenerator(), level->content
-      )) {
+      )),
+      generatorBuffer(std::make_unique<voxel[]>(CHUNK_VOL)) {
 }
 
 ChunksController::~ChunksController() = default;
@@ -51,6 +55,32 @@ void ChunksController::update(int64_t maxDuration) {
     }
 }
 
+void ChunksController::prefetch(
+    const glm::vec3& position, const glm::vec3& velocity
+) {
+    glm::vec3 predicted = position + velocity * PREFETCH_TIME;
+    int centerX = floordiv(static_cast<int>(std::floor(predicted.x)), CHUNK_W);
+    int centerZ = floordiv(static_cast<int>(std::floor(predicted.z)), CHUNK_D);
+    int radius = chunks->w / 2;
+    glm::ivec4 area(
+        floordiv(centerX - radius, REGION_SIZE),
+        floordiv(centerZ - radius, REGION_SIZE),
+        floordiv(centerX + radius, REGION_SIZE),
+        floordiv(centerZ + radius, REGION_SIZE)
+    );
+    if (area == prefetchArea) {
+        return;
+    }
+    prefetchArea = area;
+
+    auto& regions = level->getWorld()->wfile->getRegions();
+    for (int z = area.y; z <= area.w; z++) {
+        for (int x = area.x; x <= area.z; x++) {
+            regions.prefetch(x, z);
+        }
+    }
+}
+
 bool ChunksController::loadVisible() {
     const int w = chunks->w;
     const int d = chunks->d;
@@ -60,8 +90,7 @@ bool ChunksController::loadVisible() {
     int minDistance = ((w - padding * 2) / 2) * ((w - padding * 2) / 2);
     for (uint z = padding; z < d - padding; z++) {
         for (uint x = padding; x < w - padding; x++) {
-            int index = z * w + x;
-            auto& chunk = chunks->chunks[index];
+            auto& chunk = chunks->getLocal(x, z);
             if (chunk != nullptr) {
                 if (chunk->flags.loaded && !chunk->flags.lighted) {
                     if (buildLights(chunk)) {
@@ -81,7 +110,7 @@ bool ChunksController::loadVisible() {
         }
     }
 
-    const auto& chunk = chunks->chunks[nearZ * w + nearX];
+    const auto& chunk = chunks->getLocal(nearX, nearZ);
     if (chunk != nullptr) {
         return false;
     }
@@ -117,7 +146,10 @@ void ChunksController::createChunk(int x, int z) {
     auto& chunkFlags = chunk->flags;
 
     if (!chunkFlags.loaded) {
-        generator->generate(chunk->voxels, x, z, level->getWorld()->getSeed());
+        generator->generate(
+            generatorBuffer.get(), x, z, level->getWorld()->getSeed()
+        );
+        chunk->voxels.assign(generatorBuffer.get());
         chunkFlags.unsaved = true;
     }
     chunk->updateHeights();
@@ -1,6 +1,7 @@
 #ifndef VOXELS_CHUNKSCONTROLLER_HPP_
 #define VOXELS_CHUNKSCONTROLLER_HPP_
 
+#include <glm/glm.hpp>
 #include <memory>
 
 #include <typedefs.hpp>
@@ -10,6 +11,7 @@ class Chunk;
 class Chunks;
 class Lighting;
 class WorldGenerator;
+struct voxel;
 
 /// @brief ChunksController manages chunks dynamic loading/unloading
 class ChunksController {
@@ -19,6 +21,11 @@ private:
     Lighting* lighting;
     uint padding;
     std::unique_ptr<WorldGenerator> generator;
+    /// @brief Generated chunk voxels, copied to the chunk by sections
+    std::unique_ptr<voxel[]> generatorBuffer;
+    /// @brief Regions area (min x, min z, max x, max z) requested to be
+    /// prefetched last time
+    glm::ivec4 prefetchArea {};
 
     /// @brief Process one chunk: load it or calculate lights for it
     bool loadVisible();
@@ -30,6 +37,12 @@ public:
 
     /// @param maxDuration milliseconds reserved for chunks loading
     void update(int64_t maxDuration);
+
+    /// @brief Prefetch regions around the position predicted by
+    /// the player movement
+    /// @param position player position
+    /// @param velocity player velocity
+    void prefetch(const glm::vec3& position, const glm::vec3& velocity);
 };
 
 #endif  // VOXELS_CHUNKSCONTROLLER_HPP_
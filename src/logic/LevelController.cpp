@@ -38,8 +38,19 @@ void LevelController::update(float delta, bool input, bool pause) {
         position.z,
         settings.chunks.loadDistance.get() + settings.chunks.padding.get() * 2
     );
+    if (auto hitbox = player->getPlayer()->getHitbox()) {
+        chunks->prefetch(position, hitbox->velocity);
+    }
     chunks->update(settings.chunks.loadSpeed.get());
 
+    if (int interval = settings.debug.journalInterval.get()) {
+        journalTimer += delta;
+        if (journalTimer >= interval) {
+            journalTimer = 0.0f;
+            level->getWorld()->writeJournal(level.get());
+        }
+    }
+
     if (!pause) {
         // update all objects that needed
         for (const auto& obj : level->objects) {
@@ -77,6 +88,8 @@ void LevelController::saveWorld() {
 
 void LevelController::onWorldQuit() {
     scripting::on_world_quit();
+    // regions write errors are reported before the world is closed
+    level->getWorld()->wfile->waitForWrite();
 }
 
 Level* LevelController::getLevel() {
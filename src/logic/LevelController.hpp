@@ -19,6 +19,8 @@ class LevelController {
     std::unique_ptr<BlocksController> blocks;
     std::unique_ptr<ChunksController> chunks;
     std::unique_ptr<PlayerController> player;
+    /// @brief Time elapsed since the last journal write
+    float journalTimer = 0.0f;
 public:
     LevelController(EngineSettings& settings, std::unique_ptr<Level> level);
 
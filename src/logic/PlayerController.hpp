@@ -63,7 +63,7 @@ class PlayerController {
     void updateFootsteps(float delta);
     void processRightClick(const Block& def, const Block& target);
 
-    voxel* updateSelection(float maxDistance);
+    const voxel* updateSelection(float maxDistance);
 public:
     PlayerController(
         Level* level,
@@ -166,7 +166,7 @@ static int l_get_rotation(lua::State* L) {
     auto x = lua::tointeger(L, 1);
     auto y = lua::tointeger(L, 2);
     auto z = lua::tointeger(L, 3);
-    voxel* vox = level->chunks->get(x, y, z);
+    const voxel* vox = level->chunks->get(x, y, z);
     int rotation = vox == nullptr ? 0 : vox->state.rotation;
     return lua::pushinteger(L, rotation);
 }
@@ -199,9 +199,9 @@ static int l_set_states(lua::State* L) {
     if (chunk == nullptr) {
         return 0;
     }
-    auto vox = level->chunks->get(x, y, z);
+    auto vox = level->chunks->getWriteable(x, y, z);
     vox->state = int2blockstate(states);
-    chunk->setModifiedAndUnsaved();
+    chunk->setModifiedAndUnsaved(y);
     return 0;
 }
 
@@ -235,12 +235,12 @@ static int l_set_user_bits(lua::State* L) {
     if (chunk == nullptr) {
         return 0;
     }
-    auto vox = level->chunks->get(x, y, z);
+    auto vox = level->chunks->getWriteable(x, y, z);
     if (vox == nullptr) {
         return 0;
     }
     vox->state.userbits = (vox->state.userbits & (~mask)) | value;
-    chunk->setModifiedAndUnsaved();
+    chunk->setModifiedAndUnsaved(y);
     return 0;
 }
 
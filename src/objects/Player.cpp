@@ -189,7 +189,7 @@ void Player::attemptToFindSpawnpoint() {
         newpos.y--;
     }
 
-    voxel* headvox = level->chunks->get(newpos.x, newpos.y + 1, newpos.z);
+    const voxel* headvox = level->chunks->get(newpos.x, newpos.y + 1, newpos.z);
     if (level->chunks->isObstacleBlock(newpos.x, newpos.y, newpos.z) ||
         headvox == nullptr || headvox->id != 0) {
         return;
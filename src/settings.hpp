@@ -64,6 +64,9 @@ struct GraphicsSettings {
     FlagSetting backlight {true};
     /// @brief Enable chunks frustum culling
     FlagSetting frustumCulling {true};
+    /// @brief Merge coplanar faces of cube blocks with the same texture
+    /// and light into larger quads
+    FlagSetting greedyMeshing {false};
     IntegerSetting skyboxResolution {64 + 32, 64, 128};
 };
 
@@ -71,6 +74,20 @@ struct DebugSettings {
     /// @brief Turns off chunks saving/loading
     FlagSetting generatorTestMode {false};
     FlagSetting doWriteLights {true};
+    /// @brief Write chunks voxels in the palette format when it's smaller
+    FlagSetting paletteVoxels {true};
+    /// @brief Regions layers compression methods (none/extrle/deflate/lz4)
+    StringSetting voxelsCompression {"extrle"};
+    StringSetting lightsCompression {"extrle"};
+    StringSetting inventoriesCompression {"deflate"};
+    StringSetting entitiesCompression {"deflate"};
+    /// @brief Regions deflate compression level
+    IntegerSetting compressionLevel {6, 1, 9};
+    /// @brief Max memory used by chunks data kept in memory (MiB)
+    IntegerSetting regionsCacheSize {256, 16, 4096};
+    /// @brief Interval of writing changes to the regions journal
+    /// (seconds, 0 - disabled)
+    IntegerSetting journalInterval {0, 0, 600};
 };
 
 struct UiSettings {
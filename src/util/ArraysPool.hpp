@@ -0,0 +1,109 @@
+#ifndef UTIL_ARRAYS_POOL_HPP_
+#define UTIL_ARRAYS_POOL_HPP_
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <typedefs.hpp>
+
+namespace util {
+    /// @brief Thread-safe pool of same-sized arrays. Released arrays are
+    /// kept for reuse (up to the limit) instead of being freed, so arrays
+    /// of objects loaded and unloaded repeatedly are not reallocated
+    /// @tparam T array element type (trivial)
+    /// @tparam Size number of elements in an array
+    template <class T, size_t Size>
+    class ArraysPool {
+        std::vector<T*> freeArrays;
+        std::mutex mutex;
+        size_t maxFree;
+        std::atomic<size_t> used = 0;
+        std::atomic<size_t> created = 0;
+        std::atomic<size_t> reused = 0;
+    public:
+        /// @brief Deleter bringing arrays back to the pool
+        struct Releaser {
+            ArraysPool* pool = nullptr;
+
+            void operator()(T* array) const {
+                pool->release(array);
+            }
+        };
+        using array_ptr = std::unique_ptr<T[], Releaser>;
+
+        /// @param maxFree max number of kept free arrays
+        ArraysPool(size_t maxFree) : maxFree(maxFree) {
+        }
+
+        ArraysPool(const ArraysPool&) = delete;
+
+        /// @brief Frees kept arrays, arrays in use must be released first
+        ~ArraysPool() {
+            for (T* array : freeArrays) {
+                delete[] array;
+            }
+        }
+
+        /// @brief Get an array. Elements are not initialized
+        array_ptr acquire() {
+            T* array = nullptr;
+            {
+                std::lock_guard lock(mutex);
+                if (!freeArrays.empty()) {
+                    array = freeArrays.back();
+                    freeArrays.pop_back();
+                }
+            }
+            if (array) {
+                reused++;
+            } else {
+                array = new T[Size];
+                created++;
+            }
+            used++;
+            return array_ptr(array, Releaser {this});
+        }
+
+        /// @brief Bring the array back to the pool
+        void release(T* array) {
+            used--;
+            {
+                std::lock_guard lock(mutex);
+                if (freeArrays.size() < maxFree) {
+                    freeArrays.push_back(array);
+                    return;
+                }
+            }
+            delete[] array;
+        }
+
+        /// @return number of arrays in use
+        size_t getUsed() const {
+            return used;
+        }
+
+        /// @return number of arrays kept for reuse
+        size_t getFree() {
+            std::lock_guard lock(mutex);
+            return freeArrays.size();
+        }
+
+        /// @return number of arrays allocated since creation
+        size_t getCreated() const {
+            return created;
+        }
+
+        /// @return number of acquired arrays taken from the free ones
+        size_t getReused() const {
+            return reused;
+        }
+
+        static constexpr size_t getArrayBytes() {
+            return Size * sizeof(T);
+        }
+    };
+}
+
+#endif  // UTIL_ARRAYS_POOL_HPP_
@@ -36,6 +36,10 @@ namespace util {
                 freeBuffers.push(ptr);
             });
         }
+
+        size_t getBufferSize() const {
+            return bufferSize;
+        }
     };
 }
 
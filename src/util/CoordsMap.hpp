@@ -0,0 +1,139 @@
+#ifndef UTIL_COORDS_MAP_HPP_
+#define UTIL_COORDS_MAP_HPP_
+
+#include <glm/glm.hpp>
+#include <utility>
+#include <vector>
+
+#include <typedefs.hpp>
+
+namespace util {
+    /// @brief Hash map with 2D integer coordinates keys. Uses open
+    /// addressing with linear probing over a single array, so has no
+    /// per-entry allocations and neighbour keys lookups are cache-friendly
+    /// @tparam T value type (default-constructible)
+    template <class T>
+    class CoordsMap {
+        struct Entry {
+            glm::ivec2 key;
+            T value;
+            bool used = false;
+        };
+        std::vector<Entry> entries;
+        /// @brief Capacity is 2^bits
+        uint bits;
+        size_t count = 0;
+
+        size_t getSlot(const glm::ivec2& key) const {
+            uint64_t h = static_cast<uint32_t>(key.x) |
+                         (static_cast<uint64_t>(static_cast<uint32_t>(key.y))
+                          << 32);
+            // fibonacci hashing: high bits of the product are well mixed
+            return (h * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+        }
+
+        size_t getMask() const {
+            return entries.size() - 1;
+        }
+
+        /// @return slot of the key or of the empty entry to put it to
+        size_t find(const glm::ivec2& key) const {
+            size_t mask = getMask();
+            size_t slot = getSlot(key);
+            while (entries[slot].used && entries[slot].key != key) {
+                slot = (slot + 1) & mask;
+            }
+            return slot;
+        }
+
+        void rehash(uint newBits) {
+            std::vector<Entry> old(size_t(1) << newBits);
+            std::swap(entries, old);
+            bits = newBits;
+            for (auto& entry : old) {
+                if (entry.used) {
+                    Entry& dst = entries[find(entry.key)];
+                    dst.key = entry.key;
+                    dst.value = std::move(entry.value);
+                    dst.used = true;
+                }
+            }
+        }
+    public:
+        /// @param capacityBits initial capacity is 2^capacityBits
+        CoordsMap(uint capacityBits = 6)
+            : entries(size_t(1) << capacityBits), bits(capacityBits) {
+        }
+
+        /// @return pointer to the value or nullptr if key not found
+        T* get(int x, int y) {
+            Entry& entry = entries[find({x, y})];
+            return entry.used ? &entry.value : nullptr;
+        }
+
+        /// @return pointer to the value or nullptr if key not found
+        const T* get(int x, int y) const {
+            const Entry& entry = entries[find({x, y})];
+            return entry.used ? &entry.value : nullptr;
+        }
+
+        /// @brief Set value of the key, replacing the existing one
+        void put(int x, int y, T value) {
+            // load factor is kept under 0.5 to make probe sequences short
+            if ((count + 1) * 2 > entries.size()) {
+                rehash(bits + 1);
+            }
+            Entry& entry = entries[find({x, y})];
+            if (!entry.used) {
+                entry.key = {x, y};
+                entry.used = true;
+                count++;
+            }
+            entry.value = std::move(value);
+        }
+
+        /// @return true if key was found and removed
+        bool remove(int x, int y) {
+            size_t slot = find({x, y});
+            if (!entries[slot].used) {
+                return false;
+            }
+            // backward shift deletion: entries following the removed one
+            // in the probe sequence are moved to keep them reachable
+            size_t mask = getMask();
+            size_t next = (slot + 1) & mask;
+            while (entries[next].used) {
+                size_t home = getSlot(entries[next].key);
+                // move if the home slot is not between hole and next
+                if (((next - home) & mask) >= ((next - slot) & mask)) {
+                    entries[slot].key = entries[next].key;
+                    entries[slot].value = std::move(entries[next].value);
+                    slot = next;
+                }
+                next = (next + 1) & mask;
+            }
+            entries[slot].value = T();
+            entries[slot].used = false;
+            count--;
+            return true;
+        }
+
+        void clear() {
+            for (auto& entry : entries) {
+                entry.value = T();
+                entry.used = false;
+            }
+            count = 0;
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+        size_t getCapacity() const {
+            return entries.size();
+        }
+    };
+}
+
+#endif  // UTIL_COORDS_MAP_HPP_
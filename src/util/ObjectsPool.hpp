@@ -0,0 +1,62 @@
+#ifndef UTIL_OBJECTS_POOL_HPP_
+#define UTIL_OBJECTS_POOL_HPP_
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace util {
+    /// @brief Thread-safe pool of reusable objects. Released objects keep
+    /// their state (e.g. containers capacity), so objects passing data
+    /// between threads are not reallocated for every use
+    /// @tparam T object type (default-constructible)
+    template <class T>
+    class ObjectsPool {
+        std::vector<std::unique_ptr<T>> freeObjects;
+        std::mutex mutex;
+        size_t maxFree;
+    public:
+        /// @param maxFree max number of kept free objects
+        ObjectsPool(size_t maxFree) : maxFree(maxFree) {
+        }
+
+        ObjectsPool(const ObjectsPool&) = delete;
+
+        /// @brief Get an object brought back to the pool when the last
+        /// pointer is destroyed, so the pool must outlive acquired objects
+        std::shared_ptr<T> acquire() {
+            std::unique_ptr<T> object;
+            {
+                std::lock_guard lock(mutex);
+                if (!freeObjects.empty()) {
+                    object = std::move(freeObjects.back());
+                    freeObjects.pop_back();
+                }
+            }
+            if (object == nullptr) {
+                object = std::make_unique<T>();
+            }
+            return std::shared_ptr<T>(object.release(), [this](T* object) {
+                release(object);
+            });
+        }
+
+        /// @brief Bring the object back to the pool
+        void release(T* object) {
+            // deleted out of the lock if not kept
+            std::unique_ptr<T> ptr(object);
+            std::lock_guard lock(mutex);
+            if (freeObjects.size() < maxFree) {
+                freeObjects.push_back(std::move(ptr));
+            }
+        }
+
+        /// @return number of objects kept for reuse
+        size_t getFree() {
+            std::lock_guard lock(mutex);
+            return freeObjects.size();
+        }
+    };
+}
+
+#endif  // UTIL_OBJECTS_POOL_HPP_
@@ -0,0 +1,224 @@
+#ifndef UTIL_SPARSE_SECTIONS_HPP_
+#define UTIL_SPARSE_SECTIONS_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+#include <typedefs.hpp>
+#include "ArraysPool.hpp"
+
+namespace util {
+    /// @brief Fixed size array split into equal sections. Section storage
+    /// is allocated on the first write of a value differing from the
+    /// section fill value, so uniform sections take no memory.
+    /// Copies share sections storage, which is copied on the first write
+    /// to a shared section (copy-on-write). So a copy may be read from
+    /// another thread while the original is modified, but copies must be
+    /// made by the thread modifying the original
+    /// @tparam T element type (must be trivial and comparable)
+    /// @tparam SectionSize number of elements in a section
+    /// @tparam SectionsCount number of sections
+    template <class T, size_t SectionSize, size_t SectionsCount>
+    class SparseSections {
+    public:
+        using pool_t = ArraysPool<T, SectionSize>;
+        /// @brief Size of released sections storage kept for reuse
+        static constexpr size_t POOL_MAX_FREE_BYTES = 32 * 1024 * 1024;
+    private:
+        std::shared_ptr<T[]> sections[SectionsCount];
+        T fills[SectionsCount] {};
+
+        /// @param init fill storage with the section fill value
+        T* allocate(size_t section, bool init = true) {
+            sections[section] = getPool().acquire();
+            T* storage = sections[section].get();
+            if (init) {
+                std::fill_n(storage, SectionSize, fills[section]);
+            }
+            return storage;
+        }
+
+        /// @return true if section storage is used by a copy
+        bool isShared(size_t section) const {
+            if (sections[section].use_count() > 1) {
+                return true;
+            }
+            // synchronize with the last copy released by another thread
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return false;
+        }
+
+        /// @brief Replace shared section storage with own copy
+        T* unshare(size_t section) {
+            std::shared_ptr<T[]> shared = std::move(sections[section]);
+            T* storage = allocate(section, false);
+            std::copy_n(shared.get(), SectionSize, storage);
+            return storage;
+        }
+
+        /// @return section storage to be overwritten
+        T* getSectionStorage(size_t section) {
+            if (sections[section] && !isShared(section)) {
+                return sections[section].get();
+            }
+            return allocate(section, false);
+        }
+
+        static bool isUniform(const T* src) {
+            const T& first = src[0];
+            return std::all_of(
+                src + 1,
+                src + SectionSize,
+                [&first](const T& value) { return value == first; }
+            );
+        }
+    public:
+        static constexpr size_t SIZE = SectionSize * SectionsCount;
+
+        SparseSections() = default;
+
+        SparseSections(const SparseSections& other) {
+            *this = other;
+        }
+
+        /// @brief Share sections storage with the other array
+        SparseSections& operator=(const SparseSections& other) {
+            for (size_t s = 0; s < SectionsCount; s++) {
+                fills[s] = other.fills[s];
+                sections[s] = other.sections[s];
+            }
+            return *this;
+        }
+
+        inline const T& operator[](size_t index) const {
+            const auto& section = sections[index / SectionSize];
+            if (section) {
+                return section[index % SectionSize];
+            }
+            return fills[index / SectionSize];
+        }
+
+        /// @brief Get element reference allowing to modify it. Section
+        /// storage is allocated if not yet (or copied if shared)
+        inline T& getWriteable(size_t index) {
+            T* storage = getSectionWriteable(index / SectionSize);
+            return storage[index % SectionSize];
+        }
+
+        /// @brief Set element value. Section storage is not allocated
+        /// (or copied if shared) if the value is not changed
+        inline void set(size_t index, const T& value) {
+            size_t s = index / SectionSize;
+            size_t i = index % SectionSize;
+            if (sections[s] == nullptr) {
+                if (fills[s] == value) {
+                    return;
+                }
+                allocate(s)[i] = value;
+            } else if (isShared(s)) {
+                if (sections[s][i] == value) {
+                    return;
+                }
+                unshare(s)[i] = value;
+            } else {
+                sections[s][i] = value;
+            }
+        }
+
+        /// @return section elements or nullptr if section is uniform
+        /// (see getFill)
+        inline const T* getSection(size_t section) const {
+            return sections[section].get();
+        }
+
+        /// @return section elements, storage is allocated if not yet
+        /// (or copied if shared)
+        inline T* getSectionWriteable(size_t section) {
+            if (sections[section] == nullptr) {
+                return allocate(section);
+            }
+            if (isShared(section)) {
+                return unshare(section);
+            }
+            return sections[section].get();
+        }
+
+        /// @return value of all elements of the section without storage
+        inline const T& getFill(size_t section) const {
+            return fills[section];
+        }
+
+        /// @brief Set all section elements to the value releasing storage
+        void fill(size_t section, const T& value) {
+            sections[section].reset();
+            fills[section] = value;
+        }
+
+        /// @brief Set all elements to the value releasing storage
+        void fill(const T& value) {
+            for (size_t s = 0; s < SectionsCount; s++) {
+                fill(s, value);
+            }
+        }
+
+        /// @brief Copy elements of a section from the array of SectionSize
+        /// elements. Storage is allocated only if elements are not equal
+        void assignSection(size_t section, const T* src) {
+            if (isUniform(src)) {
+                fill(section, src[0]);
+            } else {
+                std::copy_n(src, SectionSize, getSectionStorage(section));
+            }
+        }
+
+        /// @brief Copy all elements from the array of SIZE elements
+        void assign(const T* src) {
+            for (size_t s = 0; s < SectionsCount; s++) {
+                assignSection(s, src + s * SectionSize);
+            }
+        }
+
+        /// @brief Copy all elements to the array of SIZE elements
+        void copyTo(T* dst) const {
+            for (size_t s = 0; s < SectionsCount; s++) {
+                T* sdst = dst + s * SectionSize;
+                if (sections[s]) {
+                    std::copy_n(sections[s].get(), SectionSize, sdst);
+                } else {
+                    std::fill_n(sdst, SectionSize, fills[s]);
+                }
+            }
+        }
+
+        /// @brief Release storage of sections with all elements equal
+        void compact() {
+            for (size_t s = 0; s < SectionsCount; s++) {
+                if (sections[s] && isUniform(sections[s].get())) {
+                    T value = sections[s][0];
+                    fill(s, value);
+                }
+            }
+        }
+
+        /// @brief Pool of sections storage shared by all arrays of the type.
+        /// Sections of unloaded chunks are reused by the loaded ones
+        static pool_t& getPool() {
+            // never destroyed, so arrays may be released at exit in any order
+            static auto* pool =
+                new pool_t(POOL_MAX_FREE_BYTES / pool_t::getArrayBytes());
+            return *pool;
+        }
+
+        /// @return number of sections with allocated storage
+        size_t getAllocatedSections() const {
+            return std::count_if(
+                std::begin(sections),
+                std::end(sections),
+                [](const auto& section) { return section != nullptr; }
+            );
+        }
+    };
+}
+
+#endif  // UTIL_SPARSE_SECTIONS_HPP_
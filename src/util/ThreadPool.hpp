@@ -161,34 +161,48 @@ namespace util {
             }
 
             bool complete = false;
+            std::queue<ThreadPoolResult<T, R>> ready;
             {
+                // results are consumed out of the lock, so workers
+                // publishing results are not blocked by the consumer
                 std::lock_guard<std::mutex> lock(resultsMutex);
-                while (!results.empty()) {
-                    ThreadPoolResult<T, R> entry = results.front();
-                    results.pop();
+                std::swap(ready, results);
+            }
+            while (!ready.empty()) {
+                ThreadPoolResult<T, R> entry = ready.front();
+                ready.pop();
 
-                    try {
-                        resultConsumer(entry.entry);
-                    } catch (std::exception& err) {
-                        logger.error() << err.what();
-                        if (onJobFailed) {
-                            onJobFailed(entry.job);
-                        }
-                        if (stopOnFail) {
-                            std::lock_guard<std::mutex> jobsLock(jobsMutex);
-                            failed = true;
-                            complete = false;
-                        }
-                        break;
+                try {
+                    resultConsumer(entry.entry);
+                } catch (std::exception& err) {
+                    logger.error() << err.what();
+                    if (onJobFailed) {
+                        onJobFailed(entry.job);
                     }
-
-                    if (!standaloneResults) {
-                        entry.locked = false;
-                        entry.variable.notify_all();
+                    if (stopOnFail) {
+                        std::lock_guard<std::mutex> jobsLock(jobsMutex);
+                        failed = true;
+                        complete = false;
                     }
+                    break;
                 }
 
-                if (onComplete && busyWorkers == 0) {
+                if (!standaloneResults) {
+                    entry.locked = false;
+                    entry.variable.notify_all();
+                }
+            }
+            {
+                std::lock_guard<std::mutex> lock(resultsMutex);
+                if (!ready.empty()) {
+                    // results left are kept in order for the next update
+                    while (!results.empty()) {
+                        ready.push(results.front());
+                        results.pop();
+                    }
+                    std::swap(ready, results);
+                }
+                if (onComplete && busyWorkers == 0 && results.empty()) {
                     std::lock_guard<std::mutex> jobsLock(jobsMutex);
                     if (jobs.empty()) {
                         onComplete();
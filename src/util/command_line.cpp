@@ -6,7 +6,10 @@
 #include <stdexcept>
 #include <string>
 
+#include <data/dynamic.hpp>
+#include <files/WorldMaintenance.hpp>
 #include <files/engine_paths.hpp>
+#include <files/files.hpp>
 
 namespace fs = std::filesystem;
 
@@ -57,10 +60,29 @@ bool perform_keyword(
         }
         paths.setUserFilesFolder(fs::path(token));
         std::cout << "userfiles folder: " << token << std::endl;
+    } else if (keyword == "--check-world" || keyword == "--compact-world") {
+        auto token = reader.next();
+        if (!fs::is_directory(fs::path(token))) {
+            throw std::runtime_error(token + " is not a directory");
+        }
+        fs::path folder(token);
+        WorldMaintenance maintenance(folder);
+        auto report = maintenance.checkRegions(keyword == "--compact-world");
+        // written to file as log messages are printed to stdout
+        fs::path reportFile = folder / fs::path("regions-report.json");
+        files::write_json(reportFile, report.get());
+        std::cout << "report: " << reportFile.u8string() << std::endl;
+        return false;
     } else if (keyword == "--help" || keyword == "-h") {
         std::cout << "VoxelEngine command-line arguments:" << std::endl;
         std::cout << " --res [path] - set resources directory" << std::endl;
         std::cout << " --dir [path] - set userfiles directory" << std::endl;
+        std::cout << " --check-world [path] - check world region files "
+                     "and write JSON report"
+                  << std::endl;
+        std::cout << " --compact-world [path] - check world region files "
+                     "and rewrite fragmented or damaged ones"
+                  << std::endl;
         return false;
     } else {
         std::cerr << "unknown argument " << keyword << std::endl;
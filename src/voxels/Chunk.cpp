@@ -1,10 +1,13 @@
 #include "Chunk.hpp"
 
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include <content/ContentLUT.hpp>
 #include <items/Inventory.hpp>
 #include <lighting/Lightmap.hpp>
+#include <util/data_io.hpp>
 #include "voxel.hpp"
 
 Chunk::Chunk(int xpos, int zpos) : x(xpos), z(zpos) {
@@ -25,18 +28,35 @@ bool Chunk::isEmpty() {
     return true;
 }
 
+static inline bool is_air_section(const ChunkVoxels& voxels, uint section) {
+    return voxels.getSection(section) == nullptr &&
+           voxels.getFill(section).id == BLOCK_AIR;
+}
+
 void Chunk::updateHeights() {
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        if (voxels[i].id != 0) {
-            bottom = i / (CHUNK_D * CHUNK_W);
-            break;
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        if (is_air_section(voxels, s)) {
+            continue;
+        }
+        const voxel* section = voxels.getSection(s);
+        uint i = 0;
+        while (section && i < CHUNK_SECTION_VOL && section[i].id == 0) {
+            i++;
         }
+        bottom = (s * CHUNK_SECTION_VOL + i) / (CHUNK_D * CHUNK_W);
+        break;
     }
-    for (int i = CHUNK_VOL - 1; i >= 0; i--) {
-        if (voxels[i].id != 0) {
-            top = i / (CHUNK_D * CHUNK_W) + 1;
-            break;
+    for (int s = CHUNK_SECTIONS - 1; s >= 0; s--) {
+        if (is_air_section(voxels, s)) {
+            continue;
         }
+        const voxel* section = voxels.getSection(s);
+        int i = CHUNK_SECTION_VOL - 1;
+        while (section && i >= 0 && section[i].id == 0) {
+            i--;
+        }
+        top = (s * CHUNK_SECTION_VOL + i) / (CHUNK_D * CHUNK_W) + 1;
+        break;
     }
 }
 
@@ -69,13 +89,23 @@ std::shared_ptr<Inventory> Chunk::getBlockInventory(uint x, uint y, uint z)
 
 std::unique_ptr<Chunk> Chunk::clone() const {
     auto other = std::make_unique<Chunk>(x, z);
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        other->voxels[i] = voxels[i];
-    }
+    other->voxels = voxels;
     other->lightmap.set(&lightmap);
     return other;
 }
 
+std::shared_ptr<ChunkSnapshot> Chunk::createSnapshot() {
+    auto snapshot = std::make_shared<ChunkSnapshot>();
+    snapshot->x = x;
+    snapshot->z = z;
+    snapshot->bottom = bottom;
+    snapshot->top = top;
+    snapshot->version = ++snapshotVersion;
+    snapshot->voxels = voxels;
+    snapshot->lights = lightmap.getSections();
+    return snapshot;
+}
+
 /**
   Current chunk format:
     - byte-order: big-endian
@@ -93,10 +123,11 @@ std::unique_ptr<Chunk> Chunk::clone() const {
 std::unique_ptr<ubyte[]> Chunk::encode() const {
     auto buffer = std::make_unique<ubyte[]>(CHUNK_DATA_LEN);
     for (uint i = 0; i < CHUNK_VOL; i++) {
-        buffer[i] = voxels[i].id >> 8;
-        buffer[CHUNK_VOL + i] = voxels[i].id & 0xFF;
+        const voxel& vox = voxels[i];
+        buffer[i] = vox.id >> 8;
+        buffer[CHUNK_VOL + i] = vox.id & 0xFF;
 
-        blockstate_t state = blockstate2int(voxels[i].state);
+        blockstate_t state = blockstate2int(vox.state);
         buffer[CHUNK_VOL * 2 + i] = state >> 8;
         buffer[CHUNK_VOL * 3 + i] = state & 0xFF;
     }
@@ -104,26 +135,260 @@ std::unique_ptr<ubyte[]> Chunk::encode() const {
 }
 
 bool Chunk::decode(const ubyte* data) {
-    for (uint i = 0; i < CHUNK_VOL; i++) {
-        voxel& vox = voxels[i];
+    voxel section[CHUNK_SECTION_VOL];
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        for (uint k = 0; k < CHUNK_SECTION_VOL; k++) {
+            uint i = s * CHUNK_SECTION_VOL + k;
+            voxel& vox = section[k];
 
-        ubyte bid1 = data[i];
-        ubyte bid2 = data[CHUNK_VOL + i];
+            ubyte bid1 = data[i];
+            ubyte bid2 = data[CHUNK_VOL + i];
 
-        ubyte bst1 = data[CHUNK_VOL * 2 + i];
-        ubyte bst2 = data[CHUNK_VOL * 3 + i];
+            ubyte bst1 = data[CHUNK_VOL * 2 + i];
+            ubyte bst2 = data[CHUNK_VOL * 3 + i];
+
+            vox.id = (static_cast<blockid_t>(bid1) << 8) |
+                     static_cast<blockid_t>(bid2);
+            vox.state = int2blockstate(
+                (static_cast<blockstate_t>(bst1) << 8) |
+                static_cast<blockstate_t>(bst2)
+            );
+        }
+        voxels.assignSection(s, section);
+    }
+    return true;
+}
 
-        vox.id =
-            (static_cast<blockid_t>(bid1) << 8) | static_cast<blockid_t>(bid2);
-        vox.state = int2blockstate(
-            (static_cast<blockstate_t>(bst1) << 8) |
-            static_cast<blockstate_t>(bst2)
+/**
+  Palette chunk format:
+    - byte-order: big-endian
+    - used only if smaller than the planar format, so formats are
+      distinguished by the data length
+
+    ```cpp
+    uint8_t format = 1;
+    struct {
+        uint16_t paletteSize;
+        uint32_t palette[paletteSize]; // voxel id << 16 | voxel state
+        // palette indices of the section voxels packed lowest bits first,
+        // index size is 0 (single entry), 1, 2, 4, 8 or 16 bits
+        uint8_t indices[CHUNK_SECTION_VOL * index_bits / 8];
+    } sections[CHUNK_SECTIONS];
+    ```
+*/
+inline constexpr ubyte PALETTE_FORMAT = 1;
+inline constexpr uint PALETTE_TABLE_BITS = 13;
+inline constexpr uint PALETTE_TABLE_SIZE = 1 << PALETTE_TABLE_BITS;
+static_assert(PALETTE_TABLE_SIZE > CHUNK_SECTION_VOL);
+
+static inline uint palette_index_bits(size_t paletteSize) {
+    if (paletteSize <= 1) return 0;
+    if (paletteSize <= 2) return 1;
+    if (paletteSize <= 4) return 2;
+    if (paletteSize <= 16) return 4;
+    if (paletteSize <= 256) return 8;
+    return 16;
+}
+
+static inline uint palette_hash(uint32_t value) {
+    return (value * 2654435761U) >> (32 - PALETTE_TABLE_BITS);
+}
+
+static inline uint32_t voxel2int(const voxel& vox) {
+    return static_cast<uint32_t>(vox.id) << 16 | blockstate2int(vox.state);
+}
+
+static inline voxel int2voxel(uint32_t value) {
+    return {
+        static_cast<blockid_t>(value >> 16),
+        int2blockstate(static_cast<blockstate_t>(value & 0xFFFF))};
+}
+
+static void write_indices(
+    const uint16_t* indices, uint bits, ubyte* dst, size_t& pos
+) {
+    if (bits == 0) {
+        return;
+    }
+    if (bits == 16) {
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            dst[pos++] = indices[i] >> 8;
+            dst[pos++] = indices[i] & 0xFF;
+        }
+        return;
+    }
+    uint perByte = 8 / bits;
+    for (uint i = 0; i < CHUNK_SECTION_VOL; i += perByte) {
+        ubyte byte = 0;
+        for (uint k = 0; k < perByte; k++) {
+            byte |= indices[i + k] << (k * bits);
+        }
+        dst[pos++] = byte;
+    }
+}
+
+std::unique_ptr<ubyte[]> Chunk::encodePalette(size_t& length) const {
+    auto indices = std::make_unique<uint16_t[]>(CHUNK_VOL);
+    std::vector<uint32_t> palettes[CHUNK_SECTIONS];
+    // open addressing table of palette values (0 - empty slot)
+    auto keys = std::make_unique<uint32_t[]>(PALETTE_TABLE_SIZE);
+    auto slots = std::make_unique<uint16_t[]>(PALETTE_TABLE_SIZE);
+
+    length = 1;
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        auto& palette = palettes[s];
+        const voxel* section = voxels.getSection(s);
+        if (section == nullptr) {
+            // uniform section has no indices
+            palette.push_back(voxel2int(voxels.getFill(s)));
+            length += 2 + 4;
+            continue;
+        }
+        std::fill(slots.get(), slots.get() + PALETTE_TABLE_SIZE, 0);
+
+        uint16_t* sindices = indices.get() + s * CHUNK_SECTION_VOL;
+        uint32_t prevValue = voxel2int(section[0]);
+        uint16_t prevIndex = 0;
+        palette.push_back(prevValue);
+        keys[palette_hash(prevValue)] = prevValue;
+        slots[palette_hash(prevValue)] = 1;
+
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            uint32_t value = voxel2int(section[i]);
+            if (value != prevValue) {
+                uint slot = palette_hash(value);
+                while (slots[slot] && keys[slot] != value) {
+                    slot = (slot + 1) & (PALETTE_TABLE_SIZE - 1);
+                }
+                if (slots[slot] == 0) {
+                    palette.push_back(value);
+                    keys[slot] = value;
+                    slots[slot] = palette.size();
+                }
+                prevValue = value;
+                prevIndex = slots[slot] - 1;
+            }
+            sindices[i] = prevIndex;
+        }
+        length += 2 + palette.size() * 4 +
+                  CHUNK_SECTION_VOL * palette_index_bits(palette.size()) / 8;
+    }
+    if (length >= CHUNK_DATA_LEN) {
+        length = CHUNK_DATA_LEN;
+        return encode();
+    }
+    auto buffer = std::make_unique<ubyte[]>(length);
+    size_t pos = 0;
+    buffer[pos++] = PALETTE_FORMAT;
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        const auto& palette = palettes[s];
+        buffer[pos++] = palette.size() >> 8;
+        buffer[pos++] = palette.size() & 0xFF;
+        for (uint32_t value : palette) {
+            buffer[pos++] = value >> 24;
+            buffer[pos++] = (value >> 16) & 0xFF;
+            buffer[pos++] = (value >> 8) & 0xFF;
+            buffer[pos++] = value & 0xFF;
+        }
+        write_indices(
+            indices.get() + s * CHUNK_SECTION_VOL,
+            palette_index_bits(palette.size()),
+            buffer.get(),
+            pos
         );
     }
+    return buffer;
+}
+
+bool Chunk::decode(const ubyte* data, size_t length) {
+    if (length == CHUNK_DATA_LEN) {
+        return decode(data);
+    }
+    if (length < 1 || data[0] != PALETTE_FORMAT) {
+        return false;
+    }
+    // indices out of the palette refer to air
+    voxel palette[256] {};
+    voxel section[CHUNK_SECTION_VOL];
+    size_t pos = 1;
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        if (pos + 2 > length) {
+            return false;
+        }
+        size_t paletteSize = data[pos] << 8 | data[pos + 1];
+        pos += 2;
+        uint bits = palette_index_bits(paletteSize);
+        if (paletteSize == 0 || paletteSize > CHUNK_SECTION_VOL ||
+            pos + paletteSize * 4 + CHUNK_SECTION_VOL * bits / 8 > length) {
+            return false;
+        }
+        const ubyte* src = data + pos;
+        voxel* dst = section;
+        pos += paletteSize * 4 + CHUNK_SECTION_VOL * bits / 8;
+
+        if (bits == 16) {
+            const ubyte* indices = src + paletteSize * 4;
+            for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+                uint index = indices[i * 2] << 8 | indices[i * 2 + 1];
+                if (index >= paletteSize) {
+                    return false;
+                }
+                dst[i] = int2voxel(dataio::read_int32_big(src, index * 4));
+            }
+            voxels.assignSection(s, section);
+            continue;
+        }
+        for (size_t i = 0; i < paletteSize; i++) {
+            palette[i] = int2voxel(dataio::read_int32_big(src, i * 4));
+        }
+        const ubyte* indices = src + paletteSize * 4;
+        switch (bits) {
+            case 0:
+                voxels.fill(s, palette[0]);
+                break;
+            case 8:
+                for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+                    dst[i] = palette[indices[i]];
+                }
+                break;
+            default: {
+                uint perByte = 8 / bits;
+                uint mask = (1 << bits) - 1;
+                for (uint i = 0; i < CHUNK_SECTION_VOL; i += perByte) {
+                    uint byte = indices[i / perByte];
+                    for (uint k = 0; k < perByte; k++) {
+                        dst[i + k] = palette[(byte >> (k * bits)) & mask];
+                    }
+                }
+                break;
+            }
+        }
+        if (bits) {
+            voxels.assignSection(s, section);
+        }
+        std::fill(palette, palette + paletteSize, voxel {});
+    }
     return true;
 }
 
-void Chunk::convert(ubyte* data, const ContentLUT* lut) {
+void Chunk::convert(ubyte* data, size_t length, const ContentLUT* lut) {
+    if (length != CHUNK_DATA_LEN) {
+        // palette format: only palette entries are replaced
+        size_t pos = 1;
+        for (uint s = 0; s < CHUNK_SECTIONS && pos + 2 <= length; s++) {
+            size_t paletteSize = data[pos] << 8 | data[pos + 1];
+            pos += 2;
+            for (size_t i = 0; i < paletteSize && pos + 4 <= length; i++) {
+                blockid_t id = data[pos] << 8 | data[pos + 1];
+                blockid_t replacement = lut->blocks.getId(id);
+                data[pos] = replacement >> 8;
+                data[pos + 1] = replacement & 0xFF;
+                pos += 4;
+            }
+            pos += CHUNK_SECTION_VOL * palette_index_bits(paletteSize) / 8;
+        }
+        return;
+    }
     for (uint i = 0; i < CHUNK_VOL; i++) {
         // see encode method to understand what the hell is going on here
         blockid_t id =
@@ -3,14 +3,25 @@
 
 #include <stdlib.h>
 
+#include <algorithm>
 #include <memory>
 #include <unordered_map>
 
 #include <constants.hpp>
 #include <lighting/Lightmap.hpp>
+#include <util/SparseSections.hpp>
 #include "voxel.hpp"
 
 inline constexpr int CHUNK_DATA_LEN = CHUNK_VOL * 4;
+/// @brief Bitmask of all chunk sections
+inline constexpr uint CHUNK_ALL_SECTIONS = (1U << CHUNK_SECTIONS) - 1;
+static_assert(CHUNK_SECTIONS < 32);
+
+/// @brief Chunk voxels split into CHUNK_SECTIONS sections.
+/// Sections filled with a single block (air mostly) are stored as a single
+/// voxel value
+using ChunkVoxels =
+    util::SparseSections<voxel, CHUNK_SECTION_VOL, CHUNK_SECTIONS>;
 
 class Lightmap;
 class ContentLUT;
@@ -23,24 +34,44 @@ namespace dynamic {
 using chunk_inventories_map =
     std::unordered_map<uint, std::shared_ptr<Inventory>>;
 
+/// @brief Immutable copy of chunk voxels and lights. Shares sections
+/// storage with the chunk (copied on the chunk modification), so it's cheap
+/// to create and may be read from other threads while the chunk is modified
+struct ChunkSnapshot {
+    int x, z;
+    int bottom, top;
+    /// @brief Snapshot number, later snapshots of a chunk have greater ones
+    uint version;
+    ChunkVoxels voxels;
+    LightmapSections lights;
+};
+
 class Chunk {
 public:
     int x, z;
     int bottom, top;
-    voxel voxels[CHUNK_VOL] {};
+    /// @brief Use voxels.set to modify voxels, so storage of uniform
+    /// sections is allocated only when needed
+    ChunkVoxels voxels;
     Lightmap lightmap;
     struct {
-        bool modified : 1;
         bool ready : 1;
         bool loaded : 1;
         bool lighted : 1;
         bool unsaved : 1;
         bool loadedLights : 1;
         bool entities : 1;
+        /// @brief Block inventories are stored in regions, so cleared
+        /// inventories must be overwritten
+        bool inventories : 1;
     } flags {};
 
     /// @brief Block inventories map where key is index of block in voxels array
     chunk_inventories_map inventories;
+    /// @brief Version of the last snapshot created
+    uint snapshotVersion = 0;
+    /// @brief Bitmask of sections to be remeshed
+    uint modifiedSections = 0;
 
     Chunk(int x, int z);
 
@@ -51,6 +82,10 @@ public:
     // unused
     std::unique_ptr<Chunk> clone() const;
 
+    /// @brief Capture current voxels and lights. Must be called from the
+    /// thread modifying the chunk
+    std::shared_ptr<ChunkSnapshot> createSnapshot();
+
     /// @brief Creates new block inventory given size
     /// @return inventory id or 0 if block does not exists
     void addBlockInventory(
@@ -62,17 +97,47 @@ public:
     /// @return inventory bound to the given block or nullptr
     std::shared_ptr<Inventory> getBlockInventory(uint x, uint y, uint z) const;
 
-    inline void setModifiedAndUnsaved() {
-        flags.modified = true;
+    /// @return true if some sections are to be remeshed
+    inline bool isModified() const {
+        return modifiedSections != 0;
+    }
+
+    /// @brief Mark sections to be remeshed after change of a block or
+    /// light at y. Adjacent section is marked too if y is on the border,
+    /// as the section mesh depends on the neighbour blocks
+    inline void setModified(int y) {
+        int first = std::max(y - 1, 0) / CHUNK_SECTION_H;
+        int last = std::min(y + 1, CHUNK_H - 1) / CHUNK_SECTION_H;
+        for (int s = first; s <= last; s++) {
+            modifiedSections |= 1U << s;
+        }
+    }
+
+    inline void setModifiedAndUnsaved(int y) {
+        setModified(y);
         flags.unsaved = true;
     }
 
+    /// @brief Encode voxels in the planar format of CHUNK_DATA_LEN bytes
     std::unique_ptr<ubyte[]> encode() const;
 
+    /// @brief Encode voxels in the palette format if it's smaller than
+    /// the planar one, otherwise in the planar format
+    /// @param length (out argument) encoded data length
+    std::unique_ptr<ubyte[]> encodePalette(size_t& length) const;
+
+    /// @brief Decode voxels in the planar format
     /// @return true if all is fine
     bool decode(const ubyte* data);
 
-    static void convert(ubyte* data, const ContentLUT* lut);
+    /// @brief Decode voxels in the planar or the palette format
+    /// @param length encoded data length
+    /// @return true if all is fine
+    bool decode(const ubyte* data, size_t length);
+
+    /// @brief Replace block ids in encoded voxels data
+    /// @param length encoded data length
+    static void convert(ubyte* data, size_t length, const ContentLUT* lut);
 };
 
 #endif /* VOXELS_CHUNK_HPP_ */
@@ -4,6 +4,7 @@
 #include <math.h>
 
 #include <algorithm>
+#include <cstring>
 #include <vector>
 
 #include <coders/byte_utils.hpp>
@@ -31,20 +32,22 @@ Chunks::Chunks(
     WorldFiles* wfile,
     Level* level
 )
-    : level(level),
+    : ChunksMatrix(
+          w,
+          d,
+          ox,
+          oz,
+          [this](Chunk* chunk) {
+              this->level->events->trigger(EVT_CHUNK_HIDDEN, chunk);
+              save(chunk);
+          }
+      ),
+      level(level),
       indices(level->content->getIndices()),
-      chunks(w * d),
-      chunksSecond(w * d),
-      w(w),
-      d(d),
-      ox(ox),
-      oz(oz),
       worldFiles(wfile) {
-    volume = static_cast<size_t>(w) * static_cast<size_t>(d);
-    chunksCount = 0;
 }
 
-voxel* Chunks::get(int32_t x, int32_t y, int32_t z) const {
+const voxel* Chunks::get(int32_t x, int32_t y, int32_t z) const {
     x -= ox * CHUNK_W;
     z -= oz * CHUNK_D;
     int cx = floordiv(x, CHUNK_W);
@@ -53,7 +56,7 @@ voxel* Chunks::get(int32_t x, int32_t y, int32_t z) const {
     if (cx < 0 || cy < 0 || cz < 0 || cx >= int(w) || cy >= 1 || cz >= int(d)) {
         return nullptr;
     }
-    auto& chunk = chunks[cz * w + cx];  // not thread safe
+    auto& chunk = chunks[getIndex(ox + cx, oz + cz)];  // not thread safe
     if (chunk == nullptr) {
         return nullptr;
     }
@@ -63,11 +66,21 @@ voxel* Chunks::get(int32_t x, int32_t y, int32_t z) const {
     return &chunk->voxels[(ly * CHUNK_D + lz) * CHUNK_W + lx];
 }
 
+voxel* Chunks::getWriteable(int32_t x, int32_t y, int32_t z) {
+    Chunk* chunk = getChunkByVoxel(x, y, z);
+    if (chunk == nullptr) {
+        return nullptr;
+    }
+    int lx = x - chunk->x * CHUNK_W;
+    int lz = z - chunk->z * CHUNK_D;
+    return &chunk->voxels.getWriteable((y * CHUNK_D + lz) * CHUNK_W + lx);
+}
+
 const AABB* Chunks::isObstacleAt(float x, float y, float z) {
     int ix = floor(x);
     int iy = floor(y);
     int iz = floor(z);
-    voxel* v = get(ix, iy, iz);
+    const voxel* v = get(ix, iy, iz);
     if (v == nullptr) {
         if (iy >= CHUNK_H) {
             return nullptr;
@@ -97,19 +110,19 @@ const AABB* Chunks::isObstacleAt(float x, float y, float z) {
 }
 
 bool Chunks::isSolidBlock(int32_t x, int32_t y, int32_t z) {
-    voxel* v = get(x, y, z);
+    const voxel* v = get(x, y, z);
     if (v == nullptr) return false;
     return indices->blocks.get(v->id)->rt.solid;  //-V522
 }
 
 bool Chunks::isReplaceableBlock(int32_t x, int32_t y, int32_t z) {
-    voxel* v = get(x, y, z);
+    const voxel* v = get(x, y, z);
     if (v == nullptr) return false;
     return indices->blocks.get(v->id)->replaceable;  //-V522
 }
 
 bool Chunks::isObstacleBlock(int32_t x, int32_t y, int32_t z) {
-    voxel* v = get(x, y, z);
+    const voxel* v = get(x, y, z);
     if (v == nullptr) return false;
     return indices->blocks.get(v->id)->obstacle;  //-V522
 }
@@ -123,7 +136,7 @@ ubyte Chunks::getLight(int32_t x, int32_t y, int32_t z, int channel) {
     if (cx < 0 || cy < 0 || cz < 0 || cx >= int(w) || cy >= 1 || cz >= int(d)) {
         return 0;
     }
-    const auto& chunk = chunks[(cy * d + cz) * w + cx];
+    const auto& chunk = chunks[getIndex(ox + cx, oz + cz)];
     if (chunk == nullptr) {
         return 0;
     }
@@ -142,7 +155,7 @@ light_t Chunks::getLight(int32_t x, int32_t y, int32_t z) {
     if (cx < 0 || cy < 0 || cz < 0 || cx >= int(w) || cy >= 1 || cz >= int(d)) {
         return 0;
     }
-    const auto& chunk = chunks[(cy * d + cz) * w + cx];
+    const auto& chunk = chunks[getIndex(ox + cx, oz + cz)];
     if (chunk == nullptr) {
         return 0;
     }
@@ -159,17 +172,7 @@ Chunk* Chunks::getChunkByVoxel(int32_t x, int32_t y, int32_t z) {
     int cx = floordiv(x, CHUNK_W);
     int cz = floordiv(z, CHUNK_D);
     if (cx < 0 || cz < 0 || cx >= int(w) || cz >= int(d)) return nullptr;
-    return chunks[cz * w + cx].get();
-}
-
-Chunk* Chunks::getChunk(int x, int z) {
-    x -= ox;
-    z -= oz;
-    if (x < 0 || z < 0 || x >= static_cast<int>(w) ||
-        z >= static_cast<int>(d)) {
-        return nullptr;
-    }
-    return chunks[z * w + x].get();
+    return chunks[getIndex(ox + cx, oz + cz)].get();
 }
 
 glm::ivec3 Chunks::seekOrigin(
@@ -299,10 +302,10 @@ void Chunks::setRotationExtended(
                 if (vox->id != def.rt.id) {
                     set(pos.x, pos.y, pos.z, def.rt.id, segState);
                 } else {
-                    vox->state = segState;
+                    getWriteable(pos)->state = segState;
                     auto chunk = getChunkByVoxel(pos.x, pos.y, pos.z);
                     assert(chunk != nullptr);
-                    chunk->setModifiedAndUnsaved();
+                    chunk->setModifiedAndUnsaved(pos.y);
                     segmentBlocks.emplace_back(pos);
                 }
             }
@@ -341,10 +344,10 @@ void Chunks::setRotation(int32_t x, int32_t y, int32_t z, uint8_t index) {
     if (def.rt.extended) {
         setRotationExtended(def, vox->state, {x, y, z}, index);
     } else {
-        vox->state.rotation = index;
+        getWriteable(x, y, z)->state.rotation = index;
         auto chunk = getChunkByVoxel(x, y, z);
         assert(chunk != nullptr);
-        chunk->setModifiedAndUnsaved();
+        chunk->setModifiedAndUnsaved(y);
     }
 }
 
@@ -364,7 +367,7 @@ void Chunks::set(
         cz >= static_cast<int>(d)) {
         return;
     }
-    Chunk* chunk = chunks[cz * w + cx].get();
+    Chunk* chunk = chunks[getIndex(ox + cx, oz + cz)].get();
     if (chunk == nullptr) {
         return;
     }
@@ -372,7 +375,8 @@ void Chunks::set(
     int lz = z - cz * CHUNK_D;
 
     // block finalization
-    voxel& vox = chunk->voxels[(y * CHUNK_D + lz) * CHUNK_W + lx];
+    size_t index = (y * CHUNK_D + lz) * CHUNK_W + lx;
+    const voxel& vox = chunk->voxels[index];
     const auto& prevdef = indices->blocks.require(vox.id);
     if (prevdef.inventorySize == 0) {
         chunk->removeBlockInventory(lx, y, lz);
@@ -383,9 +387,8 @@ void Chunks::set(
 
     // block initialization
     const auto& newdef = indices->blocks.require(id);
-    vox.id = id;
-    vox.state = state;
-    chunk->setModifiedAndUnsaved();
+    chunk->voxels.set(index, voxel {static_cast<blockid_t>(id), state});
+    chunk->setModifiedAndUnsaved(y);
     if (!state.segment && newdef.rt.extended) {
         repairSegments(newdef, state, gx, y, gz);
     }
@@ -398,17 +401,17 @@ void Chunks::set(
         chunk->updateHeights();
 
     if (lx == 0 && (chunk = getChunk(cx + ox - 1, cz + oz)))
-        chunk->flags.modified = true;
+        chunk->setModified(y);
     if (lz == 0 && (chunk = getChunk(cx + ox, cz + oz - 1)))
-        chunk->flags.modified = true;
+        chunk->setModified(y);
 
     if (lx == CHUNK_W - 1 && (chunk = getChunk(cx + ox + 1, cz + oz)))
-        chunk->flags.modified = true;
+        chunk->setModified(y);
     if (lz == CHUNK_D - 1 && (chunk = getChunk(cx + ox, cz + oz + 1)))
-        chunk->flags.modified = true;
+        chunk->setModified(y);
 }
 
-voxel* Chunks::rayCast(
+const voxel* Chunks::rayCast(
     glm::vec3 start,
     glm::vec3 dir,
     float maxDist,
@@ -450,7 +453,7 @@ voxel* Chunks::rayCast(
     int steppedIndex = -1;
 
     while (t <= maxDist) {
-        voxel* voxel = get(ix, iy, iz);
+        const voxel* voxel = get(ix, iy, iz);
         if (voxel == nullptr) {
             return nullptr;
         }
@@ -579,7 +582,7 @@ glm::vec3 Chunks::rayCastToObstacle(
     float tzMax = (tzDelta < infinity) ? tzDelta * zdist : infinity;
 
     while (t <= maxDist) {
-        voxel* voxel = get(ix, iy, iz);
+        const voxel* voxel = get(ix, iy, iz);
         if (voxel) {
             const auto& def = indices->blocks.require(voxel->id);
             if (def.obstacle) {
@@ -650,81 +653,6 @@ void Chunks::setCenter(int32_t x, int32_t z) {
     }
 }
 
-void Chunks::translate(int32_t dx, int32_t dz) {
-    for (uint i = 0; i < volume; i++) {
-        chunksSecond[i] = nullptr;
-    }
-    for (uint32_t z = 0; z < d; z++) {
-        for (uint32_t x = 0; x < w; x++) {
-            auto chunk = chunks[z * w + x];
-            int nx = x - dx;
-            int nz = z - dz;
-            if (chunk == nullptr) continue;
-            if (nx < 0 || nz < 0 || nx >= static_cast<int>(w) ||
-                nz >= static_cast<int>(d)) {
-                level->events->trigger(EVT_CHUNK_HIDDEN, chunk.get());
-                save(chunk.get());
-                chunksCount--;
-                continue;
-            }
-            chunksSecond[nz * w + nx] = chunk;
-        }
-    }
-    std::swap(chunks, chunksSecond);
-
-    ox += dx;
-    oz += dz;
-}
-
-void Chunks::resize(uint32_t newW, uint32_t newD) {
-    if (newW < w) {
-        int delta = w - newW;
-        translate(delta / 2, 0);
-        translate(-delta, 0);
-        translate(delta, 0);
-    }
-    if (newD < d) {
-        int delta = d - newD;
-        translate(0, delta / 2);
-        translate(0, -delta);
-        translate(0, delta);
-    }
-    const int newVolume = newW * newD;
-    std::vector<std::shared_ptr<Chunk>> newChunks(newVolume);
-    std::vector<std::shared_ptr<Chunk>> newChunksSecond(newVolume);
-    for (int z = 0; z < static_cast<int>(d) && z < static_cast<int>(newD);
-         z++) {
-        for (int x = 0; x < static_cast<int>(w) && x < static_cast<int>(newW);
-             x++) {
-            newChunks[z * newW + x] = chunks[z * w + x];
-        }
-    }
-    w = newW;
-    d = newD;
-    volume = newVolume;
-    chunks = std::move(newChunks);
-    chunksSecond = std::move(newChunksSecond);
-}
-
-void Chunks::_setOffset(int32_t x, int32_t z) {
-    ox = x;
-    oz = z;
-}
-
-bool Chunks::putChunk(const std::shared_ptr<Chunk>& chunk) {
-    int x = chunk->x;
-    int z = chunk->z;
-    x -= ox;
-    z -= oz;
-    if (x < 0 || z < 0 || x >= static_cast<int>(w) ||
-        z >= static_cast<int>(d)) {
-        return false;
-    }
-    chunks[z * w + x] = chunk;
-    chunksCount++;
-    return true;
-}
-
 void Chunks::saveAndClear() {
     for (size_t i = 0; i < volume; i++) {
         auto chunk = chunks[i].get();
@@ -734,26 +662,32 @@ void Chunks::saveAndClear() {
     chunksCount = 0;
 }
 
-void Chunks::save(Chunk* chunk) {
-    if (chunk != nullptr) {
-        AABB aabb(
-            glm::vec3(chunk->x * CHUNK_W, -INFINITY, chunk->z * CHUNK_D),
-            glm::vec3(
-                (chunk->x + 1) * CHUNK_W, INFINITY, (chunk->z + 1) * CHUNK_D
-            )
-        );
-        auto entities = level->entities->getAllInside(aabb);
-        auto root = dynamic::create_map();
-        auto& list = root->putList("data");
-        for (auto& entity : entities) {
+std::vector<ubyte> Chunks::saveEntities(Chunk* chunk, bool destroy) {
+    AABB aabb(
+        glm::vec3(chunk->x * CHUNK_W, -INFINITY, chunk->z * CHUNK_D),
+        glm::vec3((chunk->x + 1) * CHUNK_W, INFINITY, (chunk->z + 1) * CHUNK_D)
+    );
+    auto entities = level->entities->getAllInside(aabb);
+    auto root = dynamic::create_map();
+    auto& list = root->putList("data");
+    for (auto& entity : entities) {
+        if (destroy) {
             level->entities->onSave(entity);
-            list.put(level->entities->serialize(entity));
-            entity.destroy();
         }
-        if (!entities.empty()) {
-            chunk->flags.entities = true;
+        list.put(level->entities->serialize(entity));
+        if (destroy) {
+            entity.destroy();
         }
-        worldFiles->getRegions().put(chunk, json::to_binary(root, true));
+    }
+    if (!entities.empty()) {
+        chunk->flags.entities = true;
+    }
+    return json::to_binary(root, false);
+}
+
+void Chunks::save(Chunk* chunk) {
+    if (chunk != nullptr) {
+        worldFiles->getRegions().put(chunk, saveEntities(chunk, true));
     }
 }
 
@@ -764,3 +698,38 @@ void Chunks::saveAll() {
         }
     }
 }
+
+void Chunks::saveModified() {
+    auto& regions = worldFiles->getRegions();
+    if (!regions.journaling) {
+        return;
+    }
+    for (size_t i = 0; i < volume; i++) {
+        auto chunk = chunks[i].get();
+        if (chunk == nullptr || !chunk->flags.lighted ||
+            !(chunk->flags.unsaved || chunk->flags.entities)) {
+            continue;
+        }
+        // flag is set again if the chunk has entities now, so the chunk
+        // that had entities gets an empty list once
+        chunk->flags.entities = false;
+        auto entities = saveEntities(chunk, false);
+        if (chunk->flags.unsaved) {
+            regions.put(chunk, std::move(entities));
+            chunk->flags.unsaved = false;
+        } else {
+            // entities are moved, spawned and killed without modifying
+            // the chunk, so they are put separately (unchanged data is
+            // not journaled again)
+            auto data = std::make_unique<ubyte[]>(entities.size());
+            std::memcpy(data.get(), entities.data(), entities.size());
+            regions.put(
+                chunk->x,
+                chunk->z,
+                REGION_LAYER_ENTITIES,
+                std::move(data),
+                entities.size()
+            );
+        }
+    }
+}
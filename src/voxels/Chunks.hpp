@@ -8,6 +8,7 @@
 #include <vector>
 
 #include <typedefs.hpp>
+#include "ChunksMatrix.hpp"
 #include "voxel.hpp"
 
 class VoxelRenderer;
@@ -21,8 +22,9 @@ class LevelEvents;
 class Block;
 class Level;
 
-/// Player-centred chunks matrix
-class Chunks {
+/// Player-centred chunks matrix. Chunks left outside when the matrix
+/// is moved are saved and unloaded
+class Chunks : public ChunksMatrix {
     Level* level;
     const ContentIndices* const indices;
 
@@ -33,14 +35,15 @@ class Chunks {
     void setRotationExtended(
         const Block& def, blockstate state, glm::ivec3 origin, uint8_t rotation
     );
+
+    /// @brief Serialize entities inside of the chunk
+    /// @param destroy destroy serialized entities (chunk is saved or
+    /// unloaded). Entities on_save events are emitted only in this case,
+    /// as journaling is not a save
+    /// @return entities data to be put to regions
+    std::vector<ubyte> saveEntities(Chunk* chunk, bool destroy);
 public:
-    std::vector<std::shared_ptr<Chunk>> chunks;
-    std::vector<std::shared_ptr<Chunk>> chunksSecond;
-    size_t volume;
-    size_t chunksCount;
     size_t visible = 0;
-    uint32_t w, d;
-    int32_t ox, oz;
     WorldFiles* worldFiles;
 
     Chunks(
@@ -53,16 +56,22 @@ public:
     );
     ~Chunks() = default;
 
-    bool putChunk(const std::shared_ptr<Chunk>& chunk);
-
-    Chunk* getChunk(int32_t x, int32_t z);
     Chunk* getChunkByVoxel(int32_t x, int32_t y, int32_t z);
-    voxel* get(int32_t x, int32_t y, int32_t z) const;
+    const voxel* get(int32_t x, int32_t y, int32_t z) const;
 
-    inline voxel* get(glm::ivec3 pos) {
+    inline const voxel* get(glm::ivec3 pos) const {
         return get(pos.x, pos.y, pos.z);
     }
 
+    /// @brief Get voxel allowing to modify it. Storage of the chunk
+    /// section is allocated if the section is uniform, so use get to read
+    /// @return voxel or nullptr if chunk is not loaded
+    voxel* getWriteable(int32_t x, int32_t y, int32_t z);
+
+    inline voxel* getWriteable(glm::ivec3 pos) {
+        return getWriteable(pos.x, pos.y, pos.z);
+    }
+
     light_t getLight(int32_t x, int32_t y, int32_t z);
     ubyte getLight(int32_t x, int32_t y, int32_t z, int channel);
     void set(int32_t x, int32_t y, int32_t z, uint32_t id, blockstate state);
@@ -88,7 +97,7 @@ public:
 
     void setRotation(int32_t x, int32_t y, int32_t z, uint8_t rotation);
 
-    voxel* rayCast(
+    const voxel* rayCast(
         glm::vec3 start,
         glm::vec3 dir,
         float maxLength,
@@ -104,16 +113,15 @@ public:
     bool isReplaceableBlock(int32_t x, int32_t y, int32_t z);
     bool isObstacleBlock(int32_t x, int32_t y, int32_t z);
 
-    // does not move chunks inside
-    void _setOffset(int32_t x, int32_t z);
-
     void setCenter(int32_t x, int32_t z);
-    void translate(int32_t x, int32_t z);
-    void resize(uint32_t newW, uint32_t newD);
 
     void saveAndClear();
     void save(Chunk* chunk);
     void saveAll();
+    /// @brief Put modified chunks and changed entities of the chunks to
+    /// regions keeping them loaded. Does nothing if regions are not
+    /// journaled
+    void saveModified();
 };
 
 #endif  // VOXELS_CHUNKS_HPP_
@@ -0,0 +1,114 @@
+#include "ChunksMatrix.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "Chunk.hpp"
+
+static uint32_t ceil_pow2(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+ChunksMatrix::ChunksMatrix(
+    uint32_t w,
+    uint32_t d,
+    int32_t ox,
+    int32_t oz,
+    chunkunloadfunc onUnload
+)
+    : storageW(ceil_pow2(w)),
+      storageD(ceil_pow2(d)),
+      onUnload(std::move(onUnload)),
+      chunks(storageW * storageD),
+      volume(chunks.size()),
+      w(w),
+      d(d),
+      ox(ox),
+      oz(oz) {
+}
+
+Chunk* ChunksMatrix::getChunk(int32_t x, int32_t z) {
+    if (x < ox || z < oz || x >= ox + static_cast<int>(w) ||
+        z >= oz + static_cast<int>(d)) {
+        return nullptr;
+    }
+    return chunks[getIndex(x, z)].get();
+}
+
+bool ChunksMatrix::putChunk(const std::shared_ptr<Chunk>& chunk) {
+    int x = chunk->x;
+    int z = chunk->z;
+    if (x < ox || z < oz || x >= ox + static_cast<int>(w) ||
+        z >= oz + static_cast<int>(d)) {
+        return false;
+    }
+    chunks[getIndex(x, z)] = chunk;
+    chunksCount++;
+    return true;
+}
+
+void ChunksMatrix::translate(int32_t dx, int32_t dz) {
+    setArea(ox + dx, oz + dz, w, d);
+}
+
+void ChunksMatrix::resize(uint32_t newW, uint32_t newD) {
+    // shrinking matrix keeps the center
+    int32_t newOx = ox + (newW < w ? (w - newW) / 2 : 0);
+    int32_t newOz = oz + (newD < d ? (d - newD) / 2 : 0);
+    setArea(newOx, newOz, newW, newD);
+}
+
+void ChunksMatrix::setArea(
+    int32_t newOx, int32_t newOz, uint32_t newW, uint32_t newD
+) {
+    // only rows and columns left outside are visited
+    int32_t x1 = ox;
+    int32_t x2 = ox + static_cast<int32_t>(w);
+    for (int32_t z = oz; z < oz + static_cast<int32_t>(d); z++) {
+        if (z < newOz || z >= newOz + static_cast<int32_t>(newD)) {
+            unloadRow(x1, x2, z);
+        } else {
+            unloadRow(x1, std::min(x2, newOx), z);
+            unloadRow(std::max(x1, newOx + static_cast<int32_t>(newW)), x2, z);
+        }
+    }
+    ox = newOx;
+    oz = newOz;
+    w = newW;
+    d = newD;
+    if (w <= storageW && d <= storageD) {
+        return;
+    }
+    // all chunks left are inside of the new area
+    storageW = std::max(storageW, ceil_pow2(w));
+    storageD = std::max(storageD, ceil_pow2(d));
+    std::vector<std::shared_ptr<Chunk>> newChunks(storageW * storageD);
+    for (auto& chunk : chunks) {
+        if (chunk) {
+            newChunks[getIndex(chunk->x, chunk->z)] = std::move(chunk);
+        }
+    }
+    chunks = std::move(newChunks);
+    volume = chunks.size();
+}
+
+void ChunksMatrix::unloadRow(int32_t x1, int32_t x2, int32_t z) {
+    for (int32_t x = x1; x < x2; x++) {
+        auto& chunk = chunks[getIndex(x, z)];
+        if (chunk == nullptr) {
+            continue;
+        }
+        onUnload(chunk.get());
+        chunksCount--;
+        chunk = nullptr;
+    }
+}
+
+void ChunksMatrix::_setOffset(int32_t x, int32_t z) {
+    ox = x;
+    oz = z;
+}
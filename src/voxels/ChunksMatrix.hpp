@@ -0,0 +1,73 @@
+#ifndef VOXELS_CHUNKS_MATRIX_HPP_
+#define VOXELS_CHUNKS_MATRIX_HPP_
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <typedefs.hpp>
+
+class Chunk;
+
+using chunkunloadfunc = std::function<void(Chunk* chunk)>;
+
+/// Chunks of a movable rectangular area. Chunks are stored in a toroidal
+/// (wrapped around) matrix indexed by chunk coordinates modulo its size,
+/// so moving the area does not move chunks inside
+class ChunksMatrix {
+    /// @brief Storage matrix size (powers of two not less than w and d)
+    uint32_t storageW, storageD;
+    /// @brief Called for every chunk left outside of the moved area
+    /// before it's removed from the matrix
+    chunkunloadfunc onUnload;
+
+    /// @brief Move and resize the matrix, unloading chunks left outside
+    void setArea(int32_t newOx, int32_t newOz, uint32_t newW, uint32_t newD);
+
+    /// @brief Unload chunks of the row z in range [x1, x2)
+    void unloadRow(int32_t x1, int32_t x2, int32_t z);
+public:
+    /// @brief Chunks storage, use getIndex to find a chunk
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    /// @brief Storage size
+    size_t volume;
+    size_t chunksCount = 0;
+    uint32_t w, d;
+    int32_t ox, oz;
+
+    ChunksMatrix(
+        uint32_t w,
+        uint32_t d,
+        int32_t ox,
+        int32_t oz,
+        chunkunloadfunc onUnload
+    );
+
+    /// @return storage index of the chunk (matrix bounds are not checked)
+    inline size_t getIndex(int32_t x, int32_t z) const {
+        return (z & (storageD - 1)) * storageW + (x & (storageW - 1));
+    }
+
+    /// @brief Get chunk by the position in the matrix
+    /// @param x matrix column in range [0, w)
+    /// @param z matrix row in range [0, d)
+    inline const std::shared_ptr<Chunk>& getLocal(
+        uint32_t x, uint32_t z
+    ) const {
+        return chunks[getIndex(ox + x, oz + z)];
+    }
+
+    /// @return chunk or nullptr if not loaded or outside of the matrix
+    Chunk* getChunk(int32_t x, int32_t z);
+
+    /// @return false if the chunk is outside of the matrix
+    bool putChunk(const std::shared_ptr<Chunk>& chunk);
+
+    // does not move chunks inside
+    void _setOffset(int32_t x, int32_t z);
+
+    void translate(int32_t x, int32_t z);
+    void resize(uint32_t newW, uint32_t newD);
+};
+
+#endif  // VOXELS_CHUNKS_MATRIX_HPP_
@@ -0,0 +1,141 @@
+#include "ChunksSnapshot.hpp"
+
+#include <algorithm>
+
+#include <maths/voxmaths.hpp>
+#include "Chunk.hpp"
+#include "ChunksStorage.hpp"
+#include "VoxelsVolume.hpp"
+
+ChunksSnapshot::ChunksSnapshot(const ChunksStorage& storage, Chunk& chunk) {
+    std::shared_ptr<Chunk> area[AREA_SIZE * AREA_SIZE];
+    storage.getNeighbours(chunk.x, chunk.z, area);
+    for (int i = 0; i < AREA_SIZE * AREA_SIZE; i++) {
+        if (area[i]) {
+            chunks[i] = area[i]->createSnapshot();
+        }
+    }
+    // chunk may be not stored yet
+    chunks[AREA_SIZE * AREA_SIZE / 2] = chunk.createSnapshot();
+}
+
+const ChunkSnapshot* ChunksSnapshot::getChunk(int cx, int cz) const {
+    const auto& center = getCenter();
+    int radius = AREA_SIZE / 2;
+    int dx = cx - center.x + radius;
+    int dz = cz - center.z + radius;
+    if (dx < 0 || dz < 0 || dx >= AREA_SIZE || dz >= AREA_SIZE) {
+        return nullptr;
+    }
+    return chunks[dz * AREA_SIZE + dx].get();
+}
+
+const ChunkSnapshot& ChunksSnapshot::getCenter() const {
+    return *chunks[AREA_SIZE * AREA_SIZE / 2];
+}
+
+/// @brief Increase red, green and blue channels by 1 (up to 15)
+static inline light_t add_backlight(light_t light) {
+    // lowest bit of a channel is set if all bits of the channel are set
+    light_t full = light & (light >> 1) & (light >> 2) & (light >> 3);
+    return light + (0x0111 & ~full);
+}
+
+static inline bool is_light_passing(
+    const std::vector<bool>& flags, blockid_t id
+) {
+    return id < flags.size() && flags[id];
+}
+
+static void add_backlight(
+    const voxel* voxels,
+    light_t* lights,
+    int length,
+    const std::vector<bool>& lightPassing
+) {
+    for (int i = 0; i < length; i++) {
+        if (is_light_passing(lightPassing, voxels[i].id)) {
+            lights[i] = add_backlight(lights[i]);
+        }
+    }
+}
+
+void ChunksSnapshot::getVoxels(
+    VoxelsVolume* volume, const std::vector<bool>* backlight
+) const {
+    voxel* voxels = volume->getVoxels();
+    light_t* lights = volume->getLights();
+    int x = volume->getX();
+    int y = volume->getY();
+    int z = volume->getZ();
+
+    int w = volume->getW();
+    int h = volume->getH();
+    int d = volume->getD();
+
+    int scx = floordiv(x, CHUNK_W);
+    int scz = floordiv(z, CHUNK_D);
+
+    int ecx = floordiv(x + w - 1, CHUNK_W);
+    int ecz = floordiv(z + d - 1, CHUNK_D);
+
+    // rows of voxels along x axis are copied at once
+    for (int cz = scz; cz <= ecz; cz++) {
+        int z1 = max(z, cz * CHUNK_D);
+        int z2 = min(z + d, (cz + 1) * CHUNK_D);
+        for (int cx = scx; cx <= ecx; cx++) {
+            int x1 = max(x, cx * CHUNK_W);
+            int length = min(x + w, (cx + 1) * CHUNK_W) - x1;
+            const ChunkSnapshot* chunk = getChunk(cx, cz);
+            for (int ly = y; ly < y + h; ly++) {
+                int section = ly / CHUNK_SECTION_H;
+                int sy = ly % CHUNK_SECTION_H;
+                // uniform sections have no storage
+                const voxel* svoxels = nullptr;
+                const light_t* slights = nullptr;
+                voxel vfill {BLOCK_VOID, {}};
+                light_t lfill = 0;
+                if (chunk) {
+                    svoxels = chunk->voxels.getSection(section);
+                    slights = chunk->lights.getSection(section);
+                    vfill = chunk->voxels.getFill(section);
+                    lfill = chunk->lights.getFill(section);
+                }
+                light_t uniformLight = lfill;
+                if (backlight && is_light_passing(*backlight, vfill.id)) {
+                    uniformLight = add_backlight(lfill);
+                }
+                for (int lz = z1; lz < z2; lz++) {
+                    uint vidx = vox_index(x1 - x, ly - y, lz - z, w, d);
+                    voxel* vdst = voxels + vidx;
+                    light_t* ldst = lights + vidx;
+                    if (svoxels == nullptr && slights == nullptr) {
+                        std::fill_n(vdst, length, vfill);
+                        std::fill_n(ldst, length, uniformLight);
+                        continue;
+                    }
+                    uint sidx = vox_index(
+                        x1 - cx * CHUNK_W,
+                        sy,
+                        lz - cz * CHUNK_D,
+                        CHUNK_W,
+                        CHUNK_D
+                    );
+                    if (svoxels) {
+                        std::copy_n(svoxels + sidx, length, vdst);
+                    } else {
+                        std::fill_n(vdst, length, vfill);
+                    }
+                    if (slights) {
+                        std::copy_n(slights + sidx, length, ldst);
+                    } else {
+                        std::fill_n(ldst, length, lfill);
+                    }
+                    if (backlight) {
+                        add_backlight(vdst, ldst, length, *backlight);
+                    }
+                }
+            }
+        }
+    }
+}
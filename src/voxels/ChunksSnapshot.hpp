@@ -0,0 +1,39 @@
+#ifndef VOXELS_CHUNKS_SNAPSHOT_HPP_
+#define VOXELS_CHUNKS_SNAPSHOT_HPP_
+
+#include <memory>
+#include <vector>
+
+#include <typedefs.hpp>
+
+class Chunk;
+class ChunksStorage;
+class VoxelsVolume;
+struct ChunkSnapshot;
+
+/// @brief Snapshots of a chunk and its loaded neighbours: all needed to
+/// build the chunk mesh without access to the live chunks
+class ChunksSnapshot {
+    static constexpr int AREA_SIZE = 3;
+    /// @brief AREA_SIZE x AREA_SIZE snapshots with the chunk in the center,
+    /// nullptr if chunk is not loaded
+    std::shared_ptr<ChunkSnapshot> chunks[AREA_SIZE * AREA_SIZE];
+
+    const ChunkSnapshot* getChunk(int cx, int cz) const;
+public:
+    /// @brief Capture the chunk with neighbours. Must be called from the
+    /// thread modifying chunks
+    ChunksSnapshot(const ChunksStorage& storage, Chunk& chunk);
+
+    const ChunkSnapshot& getCenter() const;
+
+    /// @brief Copy voxels and lights to the volume. Voxels outside of the
+    /// captured area or of not loaded chunks are BLOCK_VOID
+    /// @param backlight lightPassing flags of blocks by id, used to
+    /// increase light of light-passing blocks (nullptr to keep lights)
+    void getVoxels(
+        VoxelsVolume* volume, const std::vector<bool>* backlight = nullptr
+    ) const;
+};
+
+#endif  // VOXELS_CHUNKS_SNAPSHOT_HPP_
@@ -2,29 +2,30 @@
 #define VOXELS_CHUNKSSTORAGE_HPP_
 
 #include <memory>
-#include <unordered_map>
 
 #include <typedefs.hpp>
+#include <util/CoordsMap.hpp>
 #include "voxel.hpp"
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include "glm/gtx/hash.hpp"
-
 class Chunk;
 class Level;
-class VoxelsVolume;
 
 class ChunksStorage {
     Level* level;
-    std::unordered_map<glm::ivec2, std::shared_ptr<Chunk>> chunksMap;
+    util::CoordsMap<std::shared_ptr<Chunk>> chunksMap;
 public:
     ChunksStorage(Level* level);
     ~ChunksStorage() = default;
 
     std::shared_ptr<Chunk> get(int x, int z) const;
+
+    /// @brief Get the chunk with its neighbours in a single call
+    /// @param dst 3x3 chunks ordered by z then by x, the chunk is dst[4],
+    /// nullptr for not loaded ones
+    void getNeighbours(int x, int z, std::shared_ptr<Chunk> (&dst)[9]) const;
+
     void store(const std::shared_ptr<Chunk>& chunk);
     void remove(int x, int y);
-    void getVoxels(VoxelsVolume* volume, bool backlight = false) const;
     std::shared_ptr<Chunk> create(int x, int z);
 };
 
@@ -41,4 +41,12 @@ struct voxel {
 };
 static_assert(sizeof(voxel) == 4);
 
+inline constexpr bool operator==(const voxel& a, const voxel& b) {
+    return a.id == b.id && blockstate2int(a.state) == blockstate2int(b.state);
+}
+
+inline constexpr bool operator!=(const voxel& a, const voxel& b) {
+    return !(a == b);
+}
+
 #endif  // VOXELS_VOXEL_HPP_
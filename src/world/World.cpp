@@ -86,6 +86,14 @@ void World::write(Level* level) {
     writeResources(content);
 }
 
+void World::writeJournal(Level* level) {
+    if (!wfile->getRegions().journaling) {
+        return;
+    }
+    level->chunks->saveModified();
+    wfile->writeJournal(level->content);
+}
+
 std::unique_ptr<Level> World::create(
     const std::string& name,
     const std::string& generator,
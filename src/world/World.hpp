@@ -74,6 +74,9 @@ public:
     /// @brief Write all unsaved level data to the world directory
     void write(Level* level);
 
+    /// @brief Write modified chunks to the regions journal
+    void writeJournal(Level* level);
+
     /// @brief Check world indices and generate ContentLUT if convert required
     /// @param directory world directory
     /// @param content current Content instance
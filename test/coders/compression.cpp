@@ -0,0 +1,173 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "coders/compression.hpp"
+#include "coders/lz4.hpp"
+#include "coders/rle.hpp"
+
+using compression::Method;
+
+/// @brief Chunk-like data: long runs, short runs and noise
+static std::vector<ubyte> make_data(size_t length, uint seed) {
+    std::mt19937 random(seed);
+    std::vector<ubyte> data(length);
+    for (size_t i = 0; i < length;) {
+        size_t run = random() % 3 == 0 ? random() % 1000 : random() % 8 + 1;
+        ubyte value = random() % 6;
+        for (size_t j = 0; j < run && i < length; j++, i++) {
+            data[i] = value == 5 ? random() : value;
+        }
+    }
+    return data;
+}
+
+static std::vector<ubyte> encode(
+    const std::vector<ubyte>& data, Method method
+) {
+    std::vector<ubyte> encoded(compression::bound(data.size(), method));
+    encoded.resize(compression::compress(
+        data.data(), data.size(), encoded.data(), method
+    ));
+    return encoded;
+}
+
+class CompressionTest : public testing::TestWithParam<Method> {};
+
+TEST_P(CompressionTest, RoundTrip) {
+    for (size_t length : {0, 1, 5, 13, 100, 4096, 65536 * 3}) {
+        auto data = make_data(length, length);
+        auto encoded = encode(data, GetParam());
+        std::vector<ubyte> decoded(data.size());
+        size_t decodedLength = compression::decompress(
+            encoded.data(),
+            encoded.size(),
+            decoded.data(),
+            decoded.size(),
+            GetParam()
+        );
+        EXPECT_EQ(decodedLength, data.size());
+        EXPECT_EQ(decoded, data);
+    }
+}
+
+TEST_P(CompressionTest, DestinationTooSmall) {
+    auto data = make_data(4096, 1);
+    auto encoded = encode(data, GetParam());
+    std::vector<ubyte> decoded(data.size() - 1);
+    EXPECT_THROW(
+        compression::decompress(
+            encoded.data(),
+            encoded.size(),
+            decoded.data(),
+            decoded.size(),
+            GetParam()
+        ),
+        std::runtime_error
+    );
+}
+
+TEST_P(CompressionTest, Truncated) {
+    auto data = make_data(4096, 2);
+    auto encoded = encode(data, GetParam());
+    std::vector<ubyte> decoded(data.size());
+    for (size_t length = 0; length < encoded.size(); length++) {
+        // data is either rejected or decoded partially
+        try {
+            size_t decodedLength = compression::decompress(
+                encoded.data(),
+                length,
+                decoded.data(),
+                decoded.size(),
+                GetParam()
+            );
+            EXPECT_LT(decodedLength, data.size());
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+TEST_P(CompressionTest, Garbage) {
+    std::mt19937 random(3);
+    std::vector<ubyte> garbage(512);
+    std::vector<ubyte> decoded(1024);
+    for (int i = 0; i < 1000; i++) {
+        for (auto& value : garbage) {
+            value = random();
+        }
+        try {
+            size_t decodedLength = compression::decompress(
+                garbage.data(),
+                garbage.size(),
+                decoded.data(),
+                decoded.size(),
+                GetParam()
+            );
+            EXPECT_LE(decodedLength, decoded.size());
+        } catch (const std::runtime_error&) {
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Methods,
+    CompressionTest,
+    testing::Values(Method::EXTRLE, Method::DEFLATE, Method::LZ4),
+    [](const auto& info) { return compression::to_string(info.param); }
+);
+
+TEST(lz4, InvalidMatchOffset) {
+    ubyte decoded[64];
+    // one literal then a match at distance 0
+    const ubyte zero[] {0x10, 'a', 0x00, 0x00};
+    EXPECT_THROW(
+        lz4::decode(zero, sizeof(zero), decoded, 64), std::runtime_error
+    );
+    // one literal then a match before the output start
+    const ubyte before[] {0x10, 'a', 0x02, 0x00};
+    EXPECT_THROW(
+        lz4::decode(before, sizeof(before), decoded, 64), std::runtime_error
+    );
+}
+
+TEST(lz4, UnterminatedLength) {
+    ubyte decoded[1024];
+    const ubyte data[] {0xF0, 0xFF, 0xFF};
+    EXPECT_THROW(
+        lz4::decode(data, sizeof(data), decoded, 1024), std::runtime_error
+    );
+}
+
+TEST(extrle, LongSequence) {
+    std::vector<ubyte> data(extrle::max_sequence * 2 + 10, 7);
+    std::vector<ubyte> encoded(data.size() * 2);
+    encoded.resize(extrle::encode(data.data(), data.size(), encoded.data()));
+    // two full sequences of max_sequence + 1 bytes and a short one
+    EXPECT_EQ(encoded.size(), 3 + 3 + 2);
+
+    std::vector<ubyte> decoded(data.size());
+    EXPECT_EQ(
+        extrle::decode(
+            encoded.data(), encoded.size(), decoded.data(), decoded.size()
+        ),
+        data.size()
+    );
+    EXPECT_EQ(decoded, data);
+}
+
+TEST(extrle, SequenceOutOfBounds) {
+    ubyte decoded[16];
+    // 17 bytes sequence
+    const ubyte data[] {16, 'a'};
+    EXPECT_THROW(
+        extrle::decode(data, sizeof(data), decoded, 16), std::runtime_error
+    );
+    // extended length without the second byte
+    const ubyte truncated[] {0x81};
+    EXPECT_THROW(
+        extrle::decode(truncated, sizeof(truncated), decoded, 16),
+        std::runtime_error
+    );
+}
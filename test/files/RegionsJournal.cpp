@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "files/RegionsJournal.hpp"
+
+namespace fs = std::filesystem;
+
+struct TestRecord {
+    int x, z, layer;
+    compression::Method compression;
+    std::vector<ubyte> data;
+};
+
+class RegionsJournalTest : public testing::Test {
+protected:
+    fs::path file;
+
+    void SetUp() override {
+        auto info = testing::UnitTest::GetInstance()->current_test_info();
+        file = fs::temp_directory_path() /
+               (std::string("voxelengine-journal-") + info->name());
+        fs::remove(file);
+    }
+
+    void TearDown() override {
+        fs::remove(file);
+    }
+
+    static TestRecord make_record(int i) {
+        std::vector<ubyte> data(i * 37 % 300);
+        for (size_t k = 0; k < data.size(); k++) {
+            data[k] = k * i;
+        }
+        return {i, -i, i % 2, compression::Method::LZ4, std::move(data)};
+    }
+
+    static void append(
+        RegionsJournal& journal, const std::vector<TestRecord>& records
+    ) {
+        std::vector<JournalRecord> entries;
+        for (const auto& record : records) {
+            entries.push_back(
+                {record.x,
+                 record.z,
+                 record.layer,
+                 record.compression,
+                 record.data.data(),
+                 static_cast<uint32_t>(record.data.size())}
+            );
+        }
+        journal.append(entries);
+    }
+
+    static std::vector<TestRecord> replay(RegionsJournal& journal) {
+        std::vector<TestRecord> records;
+        size_t count = journal.replay([&](const JournalRecord& record) {
+            records.push_back(
+                {record.x,
+                 record.z,
+                 record.layer,
+                 record.compression,
+                 std::vector<ubyte>(record.data, record.data + record.size)}
+            );
+        });
+        EXPECT_EQ(count, records.size());
+        return records;
+    }
+
+    static void expect_records(
+        const std::vector<TestRecord>& actual,
+        const std::vector<TestRecord>& expected
+    ) {
+        ASSERT_EQ(actual.size(), expected.size());
+        for (size_t i = 0; i < actual.size(); i++) {
+            EXPECT_EQ(actual[i].x, expected[i].x);
+            EXPECT_EQ(actual[i].z, expected[i].z);
+            EXPECT_EQ(actual[i].layer, expected[i].layer);
+            EXPECT_EQ(actual[i].compression, expected[i].compression);
+            EXPECT_EQ(actual[i].data, expected[i].data);
+        }
+    }
+};
+
+TEST_F(RegionsJournalTest, AppendReplay) {
+    RegionsJournal journal(file);
+    EXPECT_EQ(journal.getLength(), 0);
+    EXPECT_EQ(replay(journal).size(), 0);
+
+    std::vector<TestRecord> records {make_record(1), make_record(2)};
+    append(journal, records);
+    records.push_back(make_record(3));
+    append(journal, {records.back()});
+    EXPECT_EQ(journal.getLength(), fs::file_size(file));
+
+    // opened again after restart
+    RegionsJournal reopened(file);
+    EXPECT_EQ(reopened.getLength(), fs::file_size(file));
+    expect_records(replay(reopened), records);
+
+    reopened.reset();
+    EXPECT_FALSE(fs::exists(file));
+    EXPECT_EQ(reopened.getLength(), 0);
+}
+
+TEST_F(RegionsJournalTest, TornTail) {
+    std::vector<TestRecord> records {make_record(4), make_record(5)};
+    TestRecord last = make_record(6);
+    size_t validLength;
+    size_t fullLength;
+    {
+        RegionsJournal journal(file);
+        append(journal, records);
+        validLength = journal.getLength();
+        append(journal, {last});
+        fullLength = journal.getLength();
+    }
+    std::vector<char> bytes(fullLength);
+    std::ifstream(file, std::ios::binary).read(bytes.data(), fullLength);
+
+    // interrupted append left the last record incomplete
+    for (size_t length = validLength; length < fullLength; length++) {
+        std::ofstream(file, std::ios::binary | std::ios::trunc)
+            .write(bytes.data(), length);
+        RegionsJournal journal(file);
+        expect_records(replay(journal), records);
+        ASSERT_EQ(fs::file_size(file), validLength);
+        ASSERT_EQ(journal.getLength(), validLength);
+    }
+
+    // records appended after the cut are read
+    {
+        RegionsJournal journal(file);
+        append(journal, {last});
+        records.push_back(last);
+        expect_records(replay(journal), records);
+        EXPECT_EQ(journal.getLength(), fullLength);
+    }
+}
+
+TEST_F(RegionsJournalTest, CorruptedTail) {
+    std::vector<TestRecord> records {make_record(7), make_record(8)};
+    size_t validLength;
+    {
+        RegionsJournal journal(file);
+        append(journal, records);
+        validLength = journal.getLength();
+        append(journal, {make_record(9), make_record(10)});
+    }
+    // damaged data of the first record of the second batch
+    {
+        std::fstream stream(
+            file, std::ios::binary | std::ios::in | std::ios::out
+        );
+        stream.seekp(validLength + 20);
+        stream.put(0x55);
+    }
+    RegionsJournal journal(file);
+    // all records after the damaged one are dropped
+    expect_records(replay(journal), records);
+    EXPECT_EQ(fs::file_size(file), validLength);
+}
+
+TEST_F(RegionsJournalTest, IncompleteHeader) {
+    std::ofstream(file, std::ios::binary).write(".VOX", 4);
+    RegionsJournal journal(file);
+    EXPECT_EQ(replay(journal).size(), 0);
+    EXPECT_FALSE(fs::exists(file));
+}
+
+TEST_F(RegionsJournalTest, InvalidHeader) {
+    std::ofstream(file, std::ios::binary).write(".VOXREG\0\1", 9);
+    RegionsJournal journal(file);
+    EXPECT_THROW(replay(journal), std::runtime_error);
+    // the file is not removed, as it may be something valuable
+    EXPECT_TRUE(fs::exists(file));
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "files/WorldRegions.hpp"
+#include "util/data_io.hpp"
+
+namespace fs = std::filesystem;
+
+class WorldRegionsTest : public testing::Test {
+protected:
+    fs::path directory;
+    fs::path regionFile;
+
+    void SetUp() override {
+        auto info = testing::UnitTest::GetInstance()->current_test_info();
+        directory = fs::temp_directory_path() /
+                    (std::string("voxelengine-regions-") + info->name());
+        fs::remove_all(directory);
+        fs::create_directories(directory / "regions");
+        regionFile = directory / "regions" / "0_0.bin";
+    }
+
+    void TearDown() override {
+        fs::remove_all(directory);
+    }
+
+    static void putChunk(WorldRegions& regions, int x, ubyte value) {
+        auto data = std::make_unique<ubyte[]>(CHUNK_DATA_LEN);
+        for (int i = 0; i < CHUNK_DATA_LEN; i++) {
+            data[i] = value + i / 4096;
+        }
+        regions.put(
+            x, 0, REGION_LAYER_VOXELS, std::move(data), CHUNK_DATA_LEN
+        );
+    }
+
+    static void checkChunk(WorldRegions& regions, int x, ubyte value) {
+        size_t length;
+        auto data = regions.getChunk(x, 0, length);
+        ASSERT_NE(data, nullptr) << "chunk " << x;
+        ASSERT_EQ(length, CHUNK_DATA_LEN) << "chunk " << x;
+        for (int i = 0; i < CHUNK_DATA_LEN; i++) {
+            ASSERT_EQ(data[i], static_cast<ubyte>(value + i / 4096))
+                << "chunk " << x << " byte " << i;
+        }
+    }
+
+    static void writeInt32(
+        const fs::path& filename, size_t offset, uint32_t value
+    ) {
+        ubyte bytes[4];
+        dataio::write_int32_big(value, bytes, 0);
+        std::fstream file(
+            filename, std::ios::in | std::ios::out | std::ios::binary
+        );
+        file.seekp(offset);
+        file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+    }
+
+    void writeEntryOffset(int index, uint32_t offset) {
+        writeInt32(
+            regionFile, REGION_HEADER_SIZE + index * REGION_ENTRY_SIZE, offset
+        );
+    }
+};
+
+TEST_F(WorldRegionsTest, DamagedEntryKeepsOtherChunks) {
+    {
+        WorldRegions regions(directory);
+        for (int x = 0; x < 4; x++) {
+            putChunk(regions, x, x + 1);
+        }
+        regions.write();
+    }
+    writeEntryOffset(1, 0x7FFFFF00);
+    {
+        WorldRegions regions(directory);
+        putChunk(regions, 5, 6);
+        regions.write();
+    }
+    {
+        WorldRegions regions(directory);
+        checkChunk(regions, 0, 1);
+        checkChunk(regions, 2, 3);
+        checkChunk(regions, 3, 4);
+        checkChunk(regions, 5, 6);
+        size_t length;
+        EXPECT_THROW(regions.getChunk(1, 0, length), illegal_region_format);
+    }
+    {
+        // overwriting the damaged entry
+        WorldRegions regions(directory);
+        putChunk(regions, 1, 10);
+        regions.write();
+    }
+    WorldRegions regions(directory);
+    for (int x = 0; x < 4; x++) {
+        checkChunk(regions, x, x == 1 ? 10 : x + 1);
+    }
+    checkChunk(regions, 5, 6);
+}
+
+TEST_F(WorldRegionsTest, DamagedHeaderIsMovedAside) {
+    {
+        WorldRegions regions(directory);
+        putChunk(regions, 0, 1);
+        regions.write();
+    }
+    {
+        std::fstream file(
+            regionFile, std::ios::in | std::ios::out | std::ios::binary
+        );
+        file.write("garbage", 7);
+    }
+    {
+        WorldRegions regions(directory);
+        putChunk(regions, 1, 2);
+        regions.write();
+    }
+    EXPECT_TRUE(fs::exists(directory / "regions" / "damaged_0_0.bin"));
+    EXPECT_FALSE(fs::exists(directory / "regions" / "tmp_0_0.bin"));
+
+    WorldRegions regions(directory);
+    checkChunk(regions, 1, 2);
+    size_t length;
+    EXPECT_EQ(regions.getChunk(0, 0, length), nullptr);
+}
+
+TEST_F(WorldRegionsTest, DataLengthOutOfBounds) {
+    fs::path filename = directory / "inventories" / "0_0.bin";
+    fs::create_directories(filename.parent_path());
+    {
+        WorldRegions regions(directory);
+        auto data = std::make_unique<ubyte[]>(4);
+        regions.put(0, 0, REGION_LAYER_INVENTORIES, std::move(data), 4);
+        regions.write();
+    }
+    // length prefix of the first chunk data
+    writeInt32(filename, REGION_DATA_OFFSET, 0xFFFFFFF0);
+
+    WorldRegions regions(directory);
+    EXPECT_THROW(regions.fetchInventories(0, 0), illegal_region_format);
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "files/files.hpp"
+
+namespace fs = std::filesystem;
+
+class MappedFileTest : public testing::Test {
+protected:
+    fs::path file;
+
+    void SetUp() override {
+        auto info = testing::UnitTest::GetInstance()->current_test_info();
+        file = fs::temp_directory_path() /
+               (std::string("voxelengine-mmfile-") + info->name());
+    }
+
+    void TearDown() override {
+        fs::remove(file);
+    }
+};
+
+TEST_F(MappedFileTest, Read) {
+    std::string content(10000, 'a');
+    for (size_t i = 0; i < content.size(); i++) {
+        content[i] = static_cast<char>(i * 7);
+    }
+    std::ofstream(file, std::ios::binary).write(content.data(), content.size());
+
+    files::mmfile mapped(file);
+    ASSERT_EQ(mapped.length(), content.size());
+    ASSERT_NE(mapped.getData(), nullptr);
+    EXPECT_EQ(
+        std::string(
+            reinterpret_cast<const char*>(mapped.getData()), mapped.length()
+        ),
+        content
+    );
+}
+
+TEST_F(MappedFileTest, Empty) {
+    std::ofstream(file, std::ios::binary).close();
+
+    files::mmfile mapped(file);
+    EXPECT_EQ(mapped.length(), 0);
+    EXPECT_EQ(mapped.getData(), nullptr);
+}
+
+TEST_F(MappedFileTest, Missing) {
+    EXPECT_THROW(files::mmfile {file}, std::runtime_error);
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+
+#include "graphics/render/ChunkVertex.hpp"
+
+static ChunkVertex round_trip(const ChunkVertex& vertex) {
+    uint32_t words[ChunkVertex::SIZE] {};
+    vertex.pack(words);
+    return ChunkVertex::unpack(words);
+}
+
+TEST(ChunkVertex, Size) {
+    EXPECT_LE(ChunkVertex::SIZE * sizeof(uint32_t), 12);
+}
+
+TEST(ChunkVertex, RegularPosition) {
+    const float step = 1.0f / ChunkVertex::POSITION_SCALE;
+    const float min = ChunkVertex::POSITION_MIN;
+    const float max = min + 2047 * step;
+    for (float value : {min, min + step, -0.5f, 0.0f, 0.25f, 15.5f, max}) {
+        ChunkVertex vertex {{value, value, value}, {0.5f, 0.5f}};
+        auto result = round_trip(vertex);
+        EXPECT_FALSE(result.isTiled());
+        for (int i = 0; i < 3; i++) {
+            EXPECT_FLOAT_EQ(result.position[i], value);
+        }
+    }
+    // not snapped positions are rounded to the nearest step
+    ChunkVertex vertex {{0.3f, 7.01f, 12.999f}, {}};
+    auto result = round_trip(vertex);
+    for (int i = 0; i < 3; i++) {
+        EXPECT_NEAR(result.position[i], vertex.position[i], step / 2);
+    }
+    // out of range positions are clamped
+    result = round_trip({{min - 1.0f, max + 1.0f, 0.0f}, {}});
+    EXPECT_FLOAT_EQ(result.position.x, min);
+    EXPECT_FLOAT_EQ(result.position.y, max);
+}
+
+TEST(ChunkVertex, RegularTexCoord) {
+    const float step = 1.0f / 0x7FFF;
+    for (float value : {0.0f, step, 0.5f, 1.0f - step, 1.0f}) {
+        auto result = round_trip({{}, {value, 1.0f - value}});
+        EXPECT_NEAR(result.uv.x, value, step / 2);
+        EXPECT_NEAR(result.uv.y, 1.0f - value, step / 2);
+    }
+    auto result = round_trip({{}, {-0.5f, 1.5f}});
+    EXPECT_FLOAT_EQ(result.uv.x, 0.0f);
+    EXPECT_FLOAT_EQ(result.uv.y, 1.0f);
+}
+
+TEST(ChunkVertex, Tiled) {
+    const uint maxPosition = ChunkVertex::MAX_TILED_POSITION;
+    const uint maxStart = ChunkVertex::MAX_ATLAS_SIZE - 1;
+    const uint maxSize = ChunkVertex::MAX_REGION_SIZE;
+    const uint maxTiles = ChunkVertex::MAX_TILES;
+
+    ChunkVertex vertex {
+        {-0.5f, 15.5f, maxPosition - 0.5f},
+        {0.0f, maxTiles},
+        {0, maxStart, 1, maxSize}
+    };
+    auto result = round_trip(vertex);
+    EXPECT_TRUE(result.isTiled());
+    EXPECT_EQ(result.position, vertex.position);
+    EXPECT_EQ(result.uv, vertex.uv);
+    EXPECT_EQ(result.region, vertex.region);
+
+    vertex = {{7.5f, 0.5f, 3.5f}, {maxTiles, 1.0f}, {maxStart, 0, maxSize, 1}};
+    result = round_trip(vertex);
+    EXPECT_EQ(result.position, vertex.position);
+    EXPECT_EQ(result.uv, vertex.uv);
+    EXPECT_EQ(result.region, vertex.region);
+}
+
+TEST(ChunkVertex, Light) {
+    for (uint32_t light : {0u, 1u, 0x80808080u, 0xFF000000u, 0xFFFFFFFFu}) {
+        ChunkVertex regular {{1.0f, 2.0f, 3.0f}, {0.25f, 0.75f}, {}, light};
+        EXPECT_EQ(round_trip(regular).light, light);
+
+        ChunkVertex tiled {
+            {1.5f, 2.5f, 3.5f}, {2.0f, 3.0f}, {16, 32, 16, 16}, light};
+        auto result = round_trip(tiled);
+        EXPECT_EQ(result.light, light);
+        EXPECT_EQ(result.region, tiled.region);
+    }
+}
@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "lighting/Lightmap.hpp"
+
+/// @brief Encode and decode lightmap, only skylight is expected back
+static void round_trip(const Lightmap& lightmap, size_t expectedLength) {
+    size_t length;
+    auto data = lightmap.encode(length);
+    EXPECT_EQ(length, expectedLength);
+
+    auto lights = Lightmap::decode(data.get(), length);
+    ASSERT_NE(lights, nullptr);
+    const auto& sections = lightmap.getSections();
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        ASSERT_EQ(lights[i], sections[i] & 0xF000) << "voxel " << i;
+    }
+}
+
+TEST(Lightmap, Uniform) {
+    Lightmap lightmap;
+    round_trip(lightmap, CHUNK_SECTIONS);
+
+    // sections with the same skylight but different block lights
+    std::vector<light_t> lights(CHUNK_SECTION_VOL);
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+            lights[i] = Lightmap::combine(i % 16, s % 16, 0, s % 16);
+        }
+        lightmap.setSection(s, lights.data());
+    }
+    round_trip(lightmap, CHUNK_SECTIONS);
+}
+
+TEST(Lightmap, Sections) {
+    Lightmap lightmap;
+    lightmap.setS(0, 0, 0, 15);
+    lightmap.setS(CHUNK_W - 1, CHUNK_H - 1, CHUNK_D - 1, 1);
+    round_trip(lightmap, CHUNK_SECTIONS + CHUNK_SECTION_VOL);
+}
+
+TEST(Lightmap, Planar) {
+    Lightmap lightmap;
+    for (int y = 0; y < CHUNK_H; y += CHUNK_SECTION_H) {
+        lightmap.setS(0, y, 0, 7);
+    }
+    round_trip(lightmap, LIGHTMAP_DATA_LEN);
+}
+
+TEST(Lightmap, Corrupted) {
+    Lightmap lightmap;
+    lightmap.setS(3, CHUNK_SECTION_H * 2, 5, 12);
+    size_t length;
+    auto data = lightmap.encode(length);
+    ASSERT_EQ(length, CHUNK_SECTIONS + CHUNK_SECTION_VOL / 2);
+    ASSERT_NE(Lightmap::decode(data.get(), length), nullptr);
+
+    // truncated data
+    for (size_t truncated : {size_t(0), size_t(CHUNK_SECTIONS - 1),
+                             size_t(CHUNK_SECTIONS), length - 1}) {
+        EXPECT_EQ(Lightmap::decode(data.get(), truncated), nullptr);
+    }
+    // trailing data
+    std::vector<ubyte> extended(data.get(), data.get() + length);
+    extended.push_back(0);
+    EXPECT_EQ(Lightmap::decode(extended.data(), extended.size()), nullptr);
+
+    // skylight out of range
+    data[0] = 0x10;
+    EXPECT_EQ(Lightmap::decode(data.get(), length), nullptr);
+    data[0] = 0;
+    // packed section mark without the section data
+    data[1] = 0xFF;
+    EXPECT_EQ(Lightmap::decode(data.get(), length), nullptr);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "util/CoordsMap.hpp"
+
+using util::CoordsMap;
+
+/// @brief Home slot of the key in the map of 2^bits capacity, the same
+/// as in CoordsMap (if it's changed, tests are just less targeted)
+static size_t home_slot(int x, int y, uint bits) {
+    uint64_t h = static_cast<uint32_t>(x) |
+                 (static_cast<uint64_t>(static_cast<uint32_t>(y)) << 32);
+    return (h * 0x9E3779B97F4A7C15ULL) >> (64 - bits);
+}
+
+/// @brief Find keys which home slots are the last ones, so their probe
+/// sequences wrap around the end of the entries array
+static std::vector<std::pair<int, int>> find_wrapping_keys(
+    uint bits, size_t count
+) {
+    size_t capacity = size_t(1) << bits;
+    std::vector<std::pair<int, int>> keys;
+    for (int y = -100; keys.size() < count; y++) {
+        for (int x = -100; x < 100 && keys.size() < count; x++) {
+            if (home_slot(x, y, bits) >= capacity - 2) {
+                keys.push_back({x, y});
+            }
+        }
+    }
+    return keys;
+}
+
+TEST(CoordsMap, PutGetRemove) {
+    CoordsMap<int> map;
+    EXPECT_EQ(map.get(0, 0), nullptr);
+    map.put(0, 0, 1);
+    map.put(-1, 5, 2);
+    map.put(0, 0, 3);
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_EQ(*map.get(0, 0), 3);
+    EXPECT_EQ(*map.get(-1, 5), 2);
+    EXPECT_EQ(map.get(5, -1), nullptr);
+
+    EXPECT_TRUE(map.remove(0, 0));
+    EXPECT_FALSE(map.remove(0, 0));
+    EXPECT_EQ(map.get(0, 0), nullptr);
+    EXPECT_EQ(map.size(), 1);
+}
+
+TEST(CoordsMap, RemoveAroundWraparound) {
+    const uint bits = 6;
+    // cluster crossing the end of the array (load factor stays < 0.5)
+    auto keys = find_wrapping_keys(bits, 8);
+    for (size_t removed = 0; removed < keys.size(); removed++) {
+        CoordsMap<int> map(bits);
+        for (size_t i = 0; i < keys.size(); i++) {
+            map.put(keys[i].first, keys[i].second, i);
+        }
+        ASSERT_EQ(map.getCapacity(), size_t(1) << bits);
+
+        auto [rx, ry] = keys[removed];
+        EXPECT_TRUE(map.remove(rx, ry));
+        EXPECT_EQ(map.get(rx, ry), nullptr);
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (i == removed) continue;
+            const int* value = map.get(keys[i].first, keys[i].second);
+            ASSERT_NE(value, nullptr) << "key " << i;
+            EXPECT_EQ(*value, i);
+        }
+        // reinsert
+        map.put(rx, ry, -1);
+        EXPECT_EQ(*map.get(rx, ry), -1);
+        EXPECT_EQ(map.size(), keys.size());
+        for (size_t i = 0; i < keys.size(); i++) {
+            if (i == removed) continue;
+            EXPECT_EQ(*map.get(keys[i].first, keys[i].second), i);
+        }
+    }
+}
+
+TEST(CoordsMap, RandomOperations) {
+    // small map with dense keys, so probe sequences collide and wrap
+    std::mt19937 random(0);
+    CoordsMap<int> map(2);
+    std::map<std::pair<int, int>, int> expected;
+    for (int i = 0; i < 100000; i++) {
+        int x = static_cast<int>(random() % 16) - 8;
+        int y = static_cast<int>(random() % 16) - 8;
+        if (random() % 2) {
+            map.put(x, y, i);
+            expected[{x, y}] = i;
+        } else {
+            EXPECT_EQ(map.remove(x, y), expected.erase({x, y}) != 0);
+        }
+        if (i % 1000 == 0) {
+            ASSERT_EQ(map.size(), expected.size());
+            for (int ky = -8; ky < 8; ky++) {
+                for (int kx = -8; kx < 8; kx++) {
+                    auto found = expected.find({kx, ky});
+                    const int* value = map.get(kx, ky);
+                    if (found == expected.end()) {
+                        ASSERT_EQ(value, nullptr);
+                    } else {
+                        ASSERT_NE(value, nullptr);
+                        ASSERT_EQ(*value, found->second);
+                    }
+                }
+            }
+        }
+    }
+    map.clear();
+    EXPECT_EQ(map.size(), 0);
+    EXPECT_EQ(map.get(0, 0), nullptr);
+}
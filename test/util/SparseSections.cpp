@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+
+#include "util/SparseSections.hpp"
+
+using Sections = util::SparseSections<int, 16, 4>;
+
+TEST(SparseSections, Fill) {
+    Sections array;
+    EXPECT_EQ(array.getAllocatedSections(), 0);
+    for (size_t i = 0; i < Sections::SIZE; i++) {
+        ASSERT_EQ(array[i], 0) << "element " << i;
+    }
+    array.fill(7);
+    array.fill(2, 3);
+    EXPECT_EQ(array.getAllocatedSections(), 0);
+    for (size_t i = 0; i < Sections::SIZE; i++) {
+        ASSERT_EQ(array[i], i / 16 == 2 ? 3 : 7) << "element " << i;
+    }
+    EXPECT_EQ(array.getSection(2), nullptr);
+    EXPECT_EQ(array.getFill(2), 3);
+
+    // writing the fill value keeps the section uniform
+    array.set(20, 7);
+    EXPECT_EQ(array.getAllocatedSections(), 0);
+
+    array.set(20, 5);
+    EXPECT_EQ(array.getAllocatedSections(), 1);
+    ASSERT_NE(array.getSection(1), nullptr);
+    for (size_t i = 16; i < 32; i++) {
+        ASSERT_EQ(array[i], i == 20 ? 5 : 7) << "element " << i;
+    }
+}
+
+TEST(SparseSections, Copy) {
+    Sections array;
+    array.fill(1);
+    array.set(3, 2);
+    array.getWriteable(40) = 9;
+    ASSERT_EQ(array.getAllocatedSections(), 2);
+
+    Sections copy(array);
+    EXPECT_EQ(copy.getAllocatedSections(), 2);
+    EXPECT_EQ(copy.getSection(1), nullptr);
+    for (size_t i = 0; i < Sections::SIZE; i++) {
+        ASSERT_EQ(copy[i], array[i]) << "element " << i;
+    }
+
+    // modifying the copy leaves the original intact
+    copy.set(3, 4);
+    copy.set(20, 6);
+    EXPECT_EQ(array[3], 2);
+    EXPECT_EQ(array[20], 1);
+    EXPECT_EQ(array.getSection(1), nullptr);
+    // the other modified section is still shared
+    EXPECT_EQ(copy.getSection(2), array.getSection(2));
+
+    // assignment releases storage of sections uniform in the source
+    Sections other;
+    other.fill(8);
+    copy = other;
+    EXPECT_EQ(copy.getAllocatedSections(), 0);
+    for (size_t i = 0; i < Sections::SIZE; i++) {
+        ASSERT_EQ(copy[i], 8) << "element " << i;
+    }
+    EXPECT_EQ(array.getAllocatedSections(), 2);
+}
+
+TEST(SparseSections, CopyOnWrite) {
+    Sections array;
+    array.set(3, 2);
+    const int* storage = array.getSection(0);
+
+    Sections copy(array);
+    // storage is shared until written
+    EXPECT_EQ(copy.getSection(0), storage);
+    copy.set(4, 0);
+    EXPECT_EQ(copy.getSection(0), storage);
+
+    copy.set(4, 5);
+    EXPECT_NE(copy.getSection(0), storage);
+    EXPECT_EQ(array.getSection(0), storage);
+    EXPECT_EQ(array[4], 0);
+    EXPECT_EQ(copy[3], 2);
+    EXPECT_EQ(copy[4], 5);
+
+    // storage is written in place once the copy is released
+    Sections snapshot(copy);
+    snapshot.fill(0);
+    const int* own = copy.getSection(0);
+    copy.set(6, 7);
+    EXPECT_EQ(copy.getSection(0), own);
+    EXPECT_EQ(copy[6], 7);
+}
+
+TEST(SparseSections, Release) {
+    Sections array;
+    int values[Sections::SIZE];
+    for (size_t i = 0; i < Sections::SIZE; i++) {
+        values[i] = i < 32 ? 4 : static_cast<int>(i);
+    }
+    array.assign(values);
+    // uniform sections are not allocated
+    EXPECT_EQ(array.getAllocatedSections(), 2);
+    EXPECT_EQ(array.getFill(0), 4);
+
+    int copied[Sections::SIZE];
+    array.copyTo(copied);
+    for (size_t i = 0; i < Sections::SIZE; i++) {
+        ASSERT_EQ(copied[i], values[i]) << "element " << i;
+    }
+
+    array.fill(3, 0);
+    EXPECT_EQ(array.getAllocatedSections(), 1);
+    EXPECT_EQ(array[50], 0);
+
+    int* section = array.getSectionWriteable(2);
+    std::fill_n(section, 16, 6);
+    array.getWriteable(0) = 4;
+    EXPECT_EQ(array.getAllocatedSections(), 2);
+    array.compact();
+    EXPECT_EQ(array.getAllocatedSections(), 0);
+    EXPECT_EQ(array.getFill(0), 4);
+    EXPECT_EQ(array.getFill(2), 6);
+    for (size_t i = 32; i < 48; i++) {
+        ASSERT_EQ(array[i], 6) << "element " << i;
+    }
+}
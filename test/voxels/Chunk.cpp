@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include "voxels/Chunk.hpp"
+
+static voxel make_voxel(uint id, uint state = 0) {
+    return {static_cast<blockid_t>(id), int2blockstate(state)};
+}
+
+static void expect_same_voxels(const Chunk& a, const Chunk& b) {
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        ASSERT_EQ(a.voxels[i], b.voxels[i]) << "voxel " << i;
+    }
+}
+
+static void round_trip(const Chunk& chunk, size_t expectedLength) {
+    size_t length;
+    auto data = chunk.encodePalette(length);
+    EXPECT_EQ(length, expectedLength);
+
+    Chunk decoded(0, 0);
+    ASSERT_TRUE(decoded.decode(data.get(), length));
+    expect_same_voxels(chunk, decoded);
+}
+
+/// @brief Palette format data with the same palette in all sections
+/// @param indexBits palette index size in bits (0 - 16)
+/// @param index index of all section voxels
+static std::vector<ubyte> make_palette_data(
+    uint paletteSize, uint indexBits, uint index
+) {
+    std::vector<ubyte> data {1};
+    for (uint s = 0; s < CHUNK_SECTIONS; s++) {
+        data.push_back(paletteSize >> 8);
+        data.push_back(paletteSize & 0xFF);
+        for (uint i = 0; i < paletteSize; i++) {
+            // block id is index + 1, state is zero
+            data.push_back((i + 1) >> 8);
+            data.push_back((i + 1) & 0xFF);
+            data.push_back(0);
+            data.push_back(0);
+        }
+        if (indexBits == 16) {
+            for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+                data.push_back(index >> 8);
+                data.push_back(index & 0xFF);
+            }
+        } else if (indexBits) {
+            uint perByte = 8 / indexBits;
+            ubyte byte = 0;
+            for (uint k = 0; k < perByte; k++) {
+                byte |= index << (k * indexBits);
+            }
+            data.insert(data.end(), CHUNK_SECTION_VOL / perByte, byte);
+        }
+    }
+    return data;
+}
+
+TEST(Chunk, PaletteUniform) {
+    Chunk chunk(0, 0);
+    chunk.voxels.fill(3, make_voxel(5, 0x1234));
+    // format byte and a single entry palette per section
+    round_trip(chunk, 1 + CHUNK_SECTIONS * (2 + 4));
+}
+
+TEST(Chunk, PaletteIndexSizes) {
+    // palette sizes on the edges of index sizes
+    for (uint paletteSize : {1, 2, 3, 4, 5, 16, 17, 256}) {
+        Chunk chunk(0, 0);
+        for (uint s = 0; s < CHUNK_SECTIONS; s += 3) {
+            for (uint i = 0; i < CHUNK_SECTION_VOL; i++) {
+                uint index = (i * 7 + s) % paletteSize;
+                chunk.voxels.set(
+                    s * CHUNK_SECTION_VOL + i, make_voxel(index + 1, index)
+                );
+            }
+        }
+        size_t length;
+        auto data = chunk.encodePalette(length);
+        ASSERT_LT(length, CHUNK_DATA_LEN);
+        Chunk decoded(0, 0);
+        ASSERT_TRUE(decoded.decode(data.get(), length));
+        expect_same_voxels(chunk, decoded);
+    }
+}
+
+TEST(Chunk, PaletteFallsBackToPlanar) {
+    std::mt19937 random(0);
+    Chunk chunk(0, 0);
+    for (uint i = 0; i < CHUNK_VOL; i++) {
+        chunk.voxels.set(i, make_voxel(random() & 0xFFFF, random() & 0xFFFF));
+    }
+    round_trip(chunk, CHUNK_DATA_LEN);
+}
+
+TEST(Chunk, PaletteIndicesBeyondPalette) {
+    // indices out of the palette of 1 - 8 bits index refer to air
+    for (auto [paletteSize, bits] : {std::pair {3, 2}, {5, 4}, {20, 8}}) {
+        uint index = (1 << bits) - 1;
+        auto data = make_palette_data(paletteSize, bits, index);
+        Chunk chunk(0, 0);
+        chunk.voxels.fill(0, make_voxel(7));
+        ASSERT_TRUE(chunk.decode(data.data(), data.size()));
+        for (uint i = 0; i < CHUNK_VOL; i++) {
+            ASSERT_EQ(chunk.voxels[i], voxel {}) << "voxel " << i;
+        }
+    }
+    // 16 bits index may be anything, so such data is rejected
+    auto data = make_palette_data(300, 16, 300);
+    Chunk chunk(0, 0);
+    EXPECT_FALSE(chunk.decode(data.data(), data.size()));
+}
+
+TEST(Chunk, PaletteCorrupted) {
+    auto data = make_palette_data(4, 2, 1);
+    Chunk chunk(0, 0);
+    ASSERT_TRUE(chunk.decode(data.data(), data.size()));
+    EXPECT_EQ(chunk.voxels[0], make_voxel(2));
+
+    // truncated data
+    for (size_t length : {size_t(0), size_t(1), size_t(2), data.size() - 1}) {
+        EXPECT_FALSE(chunk.decode(data.data(), length));
+    }
+    // unknown format
+    data[0] = 2;
+    EXPECT_FALSE(chunk.decode(data.data(), data.size()));
+    data[0] = 1;
+    // empty palette
+    data[1] = 0;
+    data[2] = 0;
+    EXPECT_FALSE(chunk.decode(data.data(), data.size()));
+    // palette larger than section
+    data[1] = 0xFF;
+    EXPECT_FALSE(chunk.decode(data.data(), data.size()));
+}
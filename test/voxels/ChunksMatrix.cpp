@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <set>
+
+#include "voxels/Chunk.hpp"
+#include "voxels/ChunksMatrix.hpp"
+
+/// @brief Checks the matrix against a plain 2D array of loaded chunks
+class ChunksMatrixTest : public testing::Test {
+protected:
+    static constexpr int GRID_SIZE = 128;
+    static constexpr int GRID_OFFSET = GRID_SIZE / 2;
+
+    /// @brief Chunks expected to be loaded, indexed by world position
+    Chunk* grid[GRID_SIZE][GRID_SIZE] {};
+    std::set<Chunk*> unloaded;
+    ChunksMatrix matrix {5, 3, -2, -1, [this](Chunk* chunk) {
+                             EXPECT_TRUE(unloaded.insert(chunk).second);
+                         }};
+
+    Chunk*& at(int x, int z) {
+        return grid[z + GRID_OFFSET][x + GRID_OFFSET];
+    }
+
+    bool isInside(int x, int z) const {
+        return x >= matrix.ox && z >= matrix.oz &&
+               x < matrix.ox + static_cast<int>(matrix.w) &&
+               z < matrix.oz + static_cast<int>(matrix.d);
+    }
+
+    /// @brief Put chunks to all free positions of the matrix
+    void fill() {
+        for (int z = matrix.oz; z < matrix.oz + int(matrix.d); z++) {
+            for (int x = matrix.ox; x < matrix.ox + int(matrix.w); x++) {
+                if (at(x, z)) {
+                    continue;
+                }
+                auto chunk = std::make_shared<Chunk>(x, z);
+                ASSERT_TRUE(matrix.putChunk(chunk));
+                at(x, z) = chunk.get();
+            }
+        }
+        ASSERT_FALSE(matrix.putChunk(
+            std::make_shared<Chunk>(matrix.ox - 1, matrix.oz)
+        ));
+    }
+
+    /// @brief Move the matrix and check chunks left outside are unloaded
+    template <class Func>
+    void move(const Func& func) {
+        // the matrix area before the move
+        int ox = matrix.ox;
+        int oz = matrix.oz;
+        int w = matrix.w;
+        int d = matrix.d;
+        unloaded.clear();
+        func();
+        ASSERT_TRUE(matrix.ox + int(matrix.w) <= GRID_OFFSET);
+        ASSERT_TRUE(matrix.oz + int(matrix.d) <= GRID_OFFSET);
+        ASSERT_TRUE(matrix.ox >= -GRID_OFFSET && matrix.oz >= -GRID_OFFSET);
+
+        std::set<Chunk*> expected;
+        for (int z = oz; z < oz + d; z++) {
+            for (int x = ox; x < ox + w; x++) {
+                if (at(x, z) && !isInside(x, z)) {
+                    expected.insert(at(x, z));
+                    at(x, z) = nullptr;
+                }
+            }
+        }
+        EXPECT_EQ(unloaded, expected);
+        check();
+    }
+
+    void check() {
+        size_t count = 0;
+        // also checks positions around the matrix
+        int x1 = std::max(matrix.ox - 20, -GRID_OFFSET);
+        int z1 = std::max(matrix.oz - 20, -GRID_OFFSET);
+        int x2 = std::min(matrix.ox + int(matrix.w) + 20, GRID_OFFSET);
+        int z2 = std::min(matrix.oz + int(matrix.d) + 20, GRID_OFFSET);
+        for (int z = z1; z < z2; z++) {
+            for (int x = x1; x < x2; x++) {
+                Chunk* chunk = matrix.getChunk(x, z);
+                ASSERT_EQ(chunk, isInside(x, z) ? at(x, z) : nullptr)
+                    << "chunk " << x << ", " << z;
+                if (chunk) {
+                    count++;
+                }
+            }
+        }
+        EXPECT_EQ(count, matrix.chunksCount);
+        for (uint z = 0; z < matrix.d; z++) {
+            for (uint x = 0; x < matrix.w; x++) {
+                ASSERT_EQ(
+                    matrix.getLocal(x, z).get(),
+                    at(matrix.ox + x, matrix.oz + z)
+                );
+            }
+        }
+    }
+};
+
+TEST_F(ChunksMatrixTest, Translate) {
+    fill();
+    check();
+    move([this]() { matrix.translate(1, 0); });
+    move([this]() { matrix.translate(-2, 1); });
+    fill();
+    // further than the matrix size, all chunks are unloaded
+    move([this]() { matrix.translate(7, 0); });
+    EXPECT_EQ(matrix.chunksCount, 0);
+    fill();
+    move([this]() { matrix.translate(-6, -4); });
+    EXPECT_EQ(matrix.chunksCount, 0);
+    fill();
+    // by the storage size, chunks are stored at the same indices
+    move([this]() { matrix.translate(8, 4); });
+    EXPECT_EQ(matrix.chunksCount, 0);
+    fill();
+    move([this]() { matrix.translate(-3, -2); });
+}
+
+TEST_F(ChunksMatrixTest, Resize) {
+    fill();
+    // grows beyond the storage size
+    move([this]() { matrix.resize(13, 9); });
+    fill();
+    move([this]() { matrix.translate(-5, 3); });
+    move([this]() { matrix.resize(4, 2); });
+    fill();
+    move([this]() { matrix.resize(20, 20); });
+    move([this]() { matrix.translate(30, -25); });
+    fill();
+}
+
+TEST_F(ChunksMatrixTest, RandomMoves) {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> offsets(-12, 12);
+    std::uniform_int_distribution<int> sizes(1, 12);
+    for (int i = 0; i < 200; i++) {
+        if (i % 10 == 0) {
+            uint w = sizes(random);
+            uint d = sizes(random);
+            move([this, w, d]() { matrix.resize(w, d); });
+        }
+        int dx = offsets(random);
+        int dz = offsets(random);
+        // keeps the matrix inside of the grid
+        if (std::abs(matrix.ox + dx) > 40) {
+            dx = -dx;
+        }
+        if (std::abs(matrix.oz + dz) > 40) {
+            dz = -dz;
+        }
+        move([this, dx, dz]() { matrix.translate(dx, dz); });
+        if (i % 3 == 0) {
+            fill();
+        }
+    }
+}